@@ -0,0 +1,95 @@
+// bench/bench_alloc.cpp
+//
+// Counts the heap allocations made while parsing and evaluating the arithmetic and relational
+// test programs, once per evaluation engine. Every program is run in a fresh interpreter, the
+// way the interpreter tests run them; constructing the interpreter is not counted.
+//
+// The count depends on how many children an expression stores inline; configure with
+// -DSLISP_INLINE_CHILDREN=0 to measure the interpreter without inline storage.
+//
+// Usage: bench_alloc
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "interpreter.hpp"
+
+namespace {
+
+  size_t allocationCount = 0;
+
+  const char* engineName(EvaluationEngine engine) {
+    switch (engine) {
+      case EvaluationEngine::Tree: return "tree";
+      default: return "bytecode";
+    }
+  }
+
+  struct Counts {
+    size_t parse = 0;
+    size_t eval = 0;
+  };
+
+  void countAllocations(const std::string& source, EvaluationEngine engine, Counts& counts) {
+    Interpreter interpreter;
+    interpreter.setEngine(engine);
+    std::string program = source;
+
+    size_t before = allocationCount;
+    bool parsed = interpreter.parse(program);
+    counts.parse += allocationCount - before;
+    if (!parsed) {
+      return;
+    }
+
+    before = allocationCount;
+    try {
+      Expression result = interpreter.eval();
+    } catch (const std::exception&) {
+      // Procedures that are not implemented yet still count the work done before the error
+    }
+    counts.eval += allocationCount - before;
+  }
+}
+
+void* operator new(size_t size) {
+  ++allocationCount;
+  if (void* memory = std::malloc(size != 0 ? size : 1)) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+  std::free(memory);
+}
+
+int main() {
+  const std::vector<std::pair<const char*, std::vector<std::string>>> suites = {
+    {"arithmetic", {"(+ 1 -2)", "(+ -3 1 1)", "(- 1)", "(- 1 2)",
+                    "(* 1 -1)", "(* 1 1 -1)", "(/ -1 1)", "(/ 1 -1)"}},
+    {"relational", {"(< 1 2)", "(<= 1 2)", "(<= 1 1)", "(> 2 1)", "(>= 2 1)", "(>= 2 2)", "(= 4 4)",
+                    "(< 2 1)", "(<= 2 1)", "(<= 1 0)", "(> 1 2)", "(>= 1 2)", "(>= 2 3)", "(= 0 4)"}},
+  };
+
+  std::cout << "inline children: " << SLISP_INLINE_CHILDREN << std::endl;
+  for (const auto& suite : suites) {
+    for (EvaluationEngine engine : {EvaluationEngine::Tree, EvaluationEngine::Bytecode}) {
+      Counts counts;
+      for (const std::string& program : suite.second) {
+        countAllocations(program, engine, counts);
+      }
+      std::cout << suite.first << " (" << engineName(engine) << "), " << suite.second.size() << " programs: "
+                << counts.parse << " allocations parsing, " << counts.eval << " evaluating" << std::endl;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,54 @@
+// bench/bench_aot.cpp
+//
+// Evaluates bench/model.slp, a pricing script of definitions, `if`, `and`, `or`, `pow` and
+// `log10`, with the bytecode engine and as the C++ function `model` that slisp-aot translated
+// it into (see slisp_add_aot_library in CMakeLists.txt), and checks that both give the same
+// result.
+//
+// Usage: bench_aot [iterations]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "interpreter.hpp"
+#include "model.hpp"
+
+namespace {
+
+  double microseconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  int iterations = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+  Interpreter interpreter;
+  if (!interpreter.parseFile(SLISP_MODEL_SCRIPT)) {
+    std::cerr << "Failed to parse " << SLISP_MODEL_SCRIPT << std::endl;
+    return 1;
+  }
+  Expression interpreted = interpreter.eval();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    interpreted = interpreter.eval();
+  }
+  std::cout << "interpreted: " << microseconds(start) / iterations << " us per evaluation (" << interpreted << ")"
+            << std::endl;
+
+  Environment environment;
+  Expression translated = model(environment);
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    translated = model(environment);
+  }
+  std::cout << "translated: " << microseconds(start) / iterations << " us per evaluation (" << translated << ")"
+            << std::endl;
+
+  if (!(translated == interpreted)) {
+    std::cerr << "The translated result " << translated << " differs from " << interpreted << std::endl;
+    return 1;
+  }
+  return 0;
+}
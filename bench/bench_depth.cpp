@@ -0,0 +1,95 @@
+// bench/bench_depth.cpp
+//
+// Parses and evaluates programs nested one million levels deep with every evaluation engine,
+// reporting the time of each step. Neither parsing nor evaluation recurses on the C++ stack,
+// so these programs evaluate, and a program deeper than the interpreter's depth limit is
+// rejected with an error instead of crashing.
+//
+// Two workloads are generated:
+//  - arithmetic: (+ 1 (+ 1 ... (+ 1 0))), whose value is a number.
+//  - lists: (1 (1 ... (1 1))), whose value is itself a nested list.
+//
+// Usage: bench_depth [depth]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "interpreter.hpp"
+#include "interpreter_semantic_error.hpp"
+
+namespace {
+
+  std::string generateNested(const std::string& prefix, const std::string& innermost, size_t depth) {
+    std::string program;
+    program.reserve(depth * (prefix.size() + 2) + innermost.size());
+    for (size_t i = 1; i < depth; ++i) {
+      program += '(';
+      program += prefix;
+      program += ' ';
+    }
+    program += innermost;
+    program.append(depth - 1, ')');
+    return program;
+  }
+
+  double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  bool run(const char* workload, const std::string& program, EvaluationEngine engine, const char* engineName) {
+    Interpreter interpreter;
+    interpreter.setEngine(engine);
+
+    auto start = std::chrono::steady_clock::now();
+    std::string source = program;
+    if (!interpreter.parse(source)) {
+      std::cerr << workload << ": failed to parse" << std::endl;
+      return false;
+    }
+    double parse = millisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    Expression result = interpreter.eval();
+    double eval = millisecondsSince(start);
+
+    std::cout << workload << " (" << engineName << "): parse " << parse << " ms, eval " << eval
+              << " ms (" << result << ")" << std::endl;
+    return true;
+  }
+
+  bool rejectsDeeperThanLimit(const std::string& program, size_t depth, EvaluationEngine engine) {
+    Interpreter interpreter;
+    interpreter.setEngine(engine);
+    interpreter.setDepthLimit(depth - 1);
+    std::string source = program;
+    if (!interpreter.parse(source)) {
+      return false;
+    }
+    try {
+      interpreter.eval();
+    } catch (const InterpreterSemanticError& e) {
+      return true;
+    }
+    return false;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  size_t depth = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+  std::string arithmetic = generateNested("+ 1", "(+ 1 0)", depth);
+  std::string lists = generateNested("1", "(1 1)", depth);
+
+  bool ok = true;
+  for (EvaluationEngine engine : {EvaluationEngine::Tree, EvaluationEngine::Bytecode}) {
+    const char* name = engine == EvaluationEngine::Tree ? "tree" : "bytecode";
+    ok = run("arithmetic", arithmetic, engine, name) && ok;
+    ok = run("lists", lists, engine, name) && ok;
+    if (!rejectsDeeperThanLimit(arithmetic, depth, engine)) {
+      std::cerr << "the " << name << " engine accepted a program deeper than its limit" << std::endl;
+      ok = false;
+    }
+  }
+  return ok ? 0 : 1;
+}
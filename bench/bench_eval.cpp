@@ -0,0 +1,215 @@
+// bench/bench_eval.cpp
+//
+// Parses large generated programs and evaluates each one repeatedly with every evaluation
+// engine, reporting the time per evaluation and checking that the engines agree. In a build
+// configured with -DSLISP_COUNT_COPIES=ON it also reports the Expression copies per evaluation,
+// and with -DSLISP_COUNT_OPCODES=ON the most frequent opcodes and opcode pairs of the VM.
+//
+// Two workloads are generated:
+//  - arithmetic: nested calls of the four arithmetic builtins. Its operands are all literals, so
+//    the bytecode engine computes it once, when it compiles the program.
+//  - variables: the same calls with operands read from variables, which have to be evaluated.
+//  - conditional: a begin of definitions, each choosing between two arithmetic branches with
+//    a relational test.
+//  - rules: a begin of definitions guarded by and/or tests, most of whose operands and branches
+//    are never needed.
+//  - model: a begin of definitions accumulating nested arithmetic over variables, which runs as
+//    numeric regions on unboxed numbers.
+//  - procedures: a begin of definitions accumulating the results of calls of small procedures
+//    made by lambda, one of them a closure over a captured variable.
+//  - scopes: the same, calling a procedure whose body nests a let per variable it reads, each
+//    one reading the variable of the outermost.
+//
+// Usage: bench_eval [terms] [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "interpreter.hpp"
+
+namespace {
+
+  std::string generateArithmetic(size_t terms) {
+    std::string program = "(+";
+    for (size_t i = 0; i < terms; ++i) {
+      program += " (* ";
+      program += std::to_string(i % 97);
+      program += " (- ";
+      program += std::to_string(i % 13);
+      program += " (/ 10 4)))";
+    }
+    program += ')';
+    return program;
+  }
+
+  std::string generateVariables(size_t terms) {
+    std::string program = "(begin (define ten 10) (define four 4) (+";
+    for (size_t i = 0; i < terms; ++i) {
+      program += " (* ";
+      program += std::to_string(i % 97);
+      program += " (- ";
+      program += std::to_string(i % 13);
+      program += " (/ ten four)))";
+    }
+    program += "))";
+    return program;
+  }
+
+  std::string generateConditional(size_t terms) {
+    std::string program = "(begin (define total 0)";
+    for (size_t i = 0; i < terms; ++i) {
+      program += " (define total (if (< ";
+      program += std::to_string(i % 97);
+      program += " 50) (+ total (* 2 3)) (- total (/ 10 4))))";
+    }
+    program += " (total))";
+    return program;
+  }
+
+  std::string generateRules(size_t terms) {
+    std::string program = "(begin (define hits 0)";
+    for (size_t i = 0; i < terms; ++i) {
+      std::string x = std::to_string(i % 97);
+      program += " (define hits (if (or (< " + x + " 80) (and (> " + x + " 90) (< (* " + x +
+                 " 3) 280))) (+ hits 1) (- hits (pow " + x + " 2))))";
+    }
+    program += " (hits))";
+    return program;
+  }
+
+  std::string generateModel(size_t terms) {
+    std::string program = "(begin (define x 1.5) (define y 0.25) (define total 0)";
+    for (size_t i = 0; i < terms; ++i) {
+      std::string k = std::to_string(i % 13 + 1);
+      program += " (define total (+ total (* (- (* x x) (* " + k + " y)) (/ (+ x " + k + ") (+ y 1)))))";
+    }
+    program += " (total))";
+    return program;
+  }
+
+  std::string generateProcedures(size_t terms) {
+    std::string program = "(begin (define total 0) (define step (lambda (a b) (+ (* a 0.5) b)))"
+                          " (define scale ((lambda (k) (lambda (a) (* a k))) 0.9))";
+    for (size_t i = 0; i < terms; ++i) {
+      std::string k = std::to_string(i % 13 + 1);
+      program += " (define total (scale (step total " + k + ")))";
+    }
+    program += " (total))";
+    return program;
+  }
+
+  std::string generateScopes(size_t terms) {
+    const size_t depth = 16;
+    std::string body = "(+ v0 v" + std::to_string(depth - 1) + ")";
+    for (size_t level = depth - 1; level > 0; --level) {
+      body = "(let ((v" + std::to_string(level) + " (+ v" + std::to_string(level - 1) + " v0))) " + body + ")";
+    }
+    std::string program = "(begin (define total 0) (define nest (lambda (a) (let ((v0 a)) " + body + ")))";
+    for (size_t i = 0; i < terms / depth; ++i) {
+      program += " (define total (+ total (nest " + std::to_string(i % 13 + 1) + ")))";
+    }
+    program += " (total))";
+    return program;
+  }
+
+  const char* engineName(EvaluationEngine engine) {
+    switch (engine) {
+      case EvaluationEngine::Tree: return "tree";
+      default: return "bytecode";
+    }
+  }
+
+#ifdef SLISP_COUNT_OPCODES
+  void reportOpcodes(const char* workload, int iterations) {
+    const OpcodeCounts& counts = opcodeCounts();
+    std::vector<std::tuple<uint64_t, size_t, size_t>> pairs;
+    for (size_t a = 0; a < OPCODE_COUNT; ++a) {
+      if (counts.executed[a] != 0) {
+        std::cout << workload << ": " << opcodeName(static_cast<Opcode>(a)) << " "
+                  << counts.executed[a] / iterations << " per evaluation" << std::endl;
+      }
+      for (size_t b = 0; b < OPCODE_COUNT; ++b) {
+        if (counts.pairs[a][b] != 0) {
+          pairs.emplace_back(counts.pairs[a][b], a, b);
+        }
+      }
+    }
+    std::sort(pairs.rbegin(), pairs.rend());
+    for (size_t i = 0; i < pairs.size() && i < 5; ++i) {
+      std::cout << workload << ": " << opcodeName(static_cast<Opcode>(std::get<1>(pairs[i]))) << " -> "
+                << opcodeName(static_cast<Opcode>(std::get<2>(pairs[i]))) << " "
+                << std::get<0>(pairs[i]) / iterations << " per evaluation" << std::endl;
+    }
+  }
+#endif
+
+  bool run(const char* workload, std::string program, int iterations) {
+    Interpreter interpreter;
+    if (!interpreter.parse(program)) {
+      std::cerr << workload << ": failed to parse the benchmark program" << std::endl;
+      return false;
+    }
+
+    Expression reference;
+    for (EvaluationEngine engine : {EvaluationEngine::Tree, EvaluationEngine::Bytecode}) {
+      interpreter.setEngine(engine);
+      Expression result = interpreter.eval();
+      if (engine == EvaluationEngine::Tree) {
+        reference = result;
+      } else if (!(result == reference)) {
+        std::cerr << workload << " (" << engineName(engine) << "): result " << result
+                  << " differs from " << reference << std::endl;
+        return false;
+      }
+
+#ifdef SLISP_COUNT_COPIES
+      expressionCopyCounts() = ExpressionCopyCounts{0, 0};
+#endif
+#ifdef SLISP_COUNT_OPCODES
+      opcodeCounts() = OpcodeCounts();
+#endif
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < iterations; ++i) {
+        result = interpreter.eval();
+      }
+      auto end = std::chrono::steady_clock::now();
+
+      double seconds = std::chrono::duration<double>(end - start).count();
+      std::cout << workload << " (" << engineName(engine) << "): " << seconds * 1e3 / iterations
+                << " ms per evaluation (" << result << ")" << std::endl;
+#ifdef SLISP_COUNT_COPIES
+      // The result assignments move, so every copy counted here was made inside the evaluator
+      const ExpressionCopyCounts& copies = expressionCopyCounts();
+      std::cout << workload << " (" << engineName(engine) << "): " << copies.atoms / iterations
+                << " atom copies, " << copies.lists / iterations << " list copies per evaluation" << std::endl;
+#endif
+#ifdef SLISP_COUNT_OPCODES
+      if (engine == EvaluationEngine::Bytecode) {
+        reportOpcodes(workload, iterations);
+      }
+#endif
+    }
+    return true;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  size_t terms = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+  int iterations = argc > 2 ? std::atoi(argv[2]) : 50;
+
+  if (!run("arithmetic", generateArithmetic(terms), iterations) ||
+      !run("variables", generateVariables(terms), iterations) ||
+      !run("conditional", generateConditional(terms), iterations) ||
+      !run("rules", generateRules(terms), iterations) ||
+      !run("model", generateModel(terms), iterations) ||
+      !run("procedures", generateProcedures(terms), iterations) ||
+      !run("scopes", generateScopes(terms), iterations)) {
+    return 1;
+  }
+  return 0;
+}
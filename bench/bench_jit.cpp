@@ -0,0 +1,94 @@
+// bench/bench_jit.cpp
+//
+// Evaluates numeric programs with the bytecode engine, first interpreted and then with the JIT
+// compiling their numeric regions to machine code, and checks that both give the same result.
+// Only built when CMake is configured with -DSLISP_JIT=ON.
+//
+//  - pricing: a begin of definitions accumulating a discounted value per term, with `pow` and
+//    `log10` calls, which the machine code makes through the C library.
+//  - model: a begin of definitions accumulating nested arithmetic over variables.
+//
+// The evaluation that compiles the regions (the JIT_THRESHOLD-th) is timed separately.
+//
+// Usage: bench_jit [terms] [iterations]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "interpreter.hpp"
+
+namespace {
+
+  std::string generatePricing(size_t terms) {
+    std::string program = "(begin (define rate 0.05) (define spot 100) (define total 0)";
+    for (size_t i = 0; i < terms; ++i) {
+      std::string k = std::to_string(i % 30 + 1);
+      program += " (define total (+ total (/ (* spot (pow (+ 1 rate) " + k + ")) (log10 (+ spot (* " + k +
+                 " rate))))))";
+    }
+    program += " (total))";
+    return program;
+  }
+
+  std::string generateModel(size_t terms) {
+    std::string program = "(begin (define x 1.5) (define y 0.25) (define total 0)";
+    for (size_t i = 0; i < terms; ++i) {
+      std::string k = std::to_string(i % 13 + 1);
+      program += " (define total (+ total (* (- (* x x) (* " + k + " y)) (/ (+ x " + k + ") (+ y 1)))))";
+    }
+    program += " (total))";
+    return program;
+  }
+
+  double milliseconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e3;
+  }
+
+  bool run(const char* workload, std::string program, int iterations) {
+    Expression reference;
+    for (bool jit : {false, true}) {
+      const char* name = jit ? "jit" : "interpreted";
+      Interpreter interpreter;
+      interpreter.setJit(jit);
+      if (!interpreter.parse(program)) {
+        std::cerr << workload << ": failed to parse the benchmark program" << std::endl;
+        return false;
+      }
+
+      Expression result;
+      for (uint32_t i = 1; i < JIT_THRESHOLD; ++i) {
+        result = interpreter.eval();
+      }
+      auto start = std::chrono::steady_clock::now();
+      result = interpreter.eval(); // Compiles the regions when the JIT is enabled
+      std::cout << workload << " (" << name << "): " << milliseconds(start) << " ms for the warm-up evaluation"
+                << std::endl;
+
+      start = std::chrono::steady_clock::now();
+      for (int i = 0; i < iterations; ++i) {
+        result = interpreter.eval();
+      }
+      std::cout << workload << " (" << name << "): " << milliseconds(start) / iterations
+                << " ms per evaluation (" << result << ")" << std::endl;
+
+      if (!jit) {
+        reference = result;
+      } else if (!(result == reference)) {
+        std::cerr << workload << ": JIT result " << result << " differs from " << reference << std::endl;
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  size_t terms = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+  int iterations = argc > 2 ? std::atoi(argv[2]) : 10000;
+  if (!run("pricing", generatePricing(terms), iterations) || !run("model", generateModel(terms), iterations)) {
+    return 1;
+  }
+  return 0;
+}
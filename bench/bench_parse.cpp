@@ -0,0 +1,47 @@
+// bench/bench_parse.cpp
+//
+// Measures how parse time grows with the length of a single list, from 1k to 1M elements.
+// A linear-time parser keeps the time per element roughly constant across sizes.
+//
+// Usage: bench_parse
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "interpreter.hpp"
+
+namespace {
+
+  std::string generateList(size_t elements) {
+    std::string program = "(+";
+    for (size_t i = 0; i < elements; ++i) {
+      program += ' ';
+      program += std::to_string(i % 1000);
+    }
+    program += ')';
+    return program;
+  }
+}
+
+int main() {
+  for (size_t elements = 1000; elements <= 1000000; elements *= 10) {
+    std::string program = generateList(elements);
+    Interpreter interpreter;
+
+    auto start = std::chrono::steady_clock::now();
+    bool ok = interpreter.parse(program);
+    auto end = std::chrono::steady_clock::now();
+
+    if (!ok) {
+      std::cerr << "failed to parse a list of " << elements << " elements" << std::endl;
+      return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << elements << " elements: " << seconds * 1e3 << " ms, "
+              << seconds * 1e9 / elements << " ns/element" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,89 @@
+// bench/bench_tail.cpp
+//
+// Evaluates two counters whose every step is in tail position, with every evaluation engine,
+// under a nesting depth limit of a few levels:
+//  - nested: each step is a list in tail position,
+//
+//      (if (< n STEPS) (begin (define n (+ n 1)) NEXT-STEP) n)
+//
+//    so the program is nested as deeply as it has steps, but every step sits in a branch of `if`
+//    and in the last operand of `begin`.
+//  - recursive: each step is a tail call of a procedure,
+//
+//      (begin (define count (lambda (n) (if (< n STEPS) (count (+ n 1)) n))) (count 0))
+//
+// Either only evaluates under the small limit if each step takes over the frame of the one
+// before it instead of nesting inside it.
+//
+// Usage: bench_tail [nested steps] [recursive steps]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "interpreter.hpp"
+#include "interpreter_semantic_error.hpp"
+
+namespace {
+
+  std::string generateCounter(size_t steps) {
+    std::string limit = std::to_string(steps);
+    std::string step = "(if (< n " + limit + ") (begin (define n (+ n 1)) ";
+    std::string program = "(begin (define n 0) ";
+    program.reserve(steps * (step.size() + 4) + 32);
+    for (size_t i = 0; i < steps; ++i) {
+      program += step;
+    }
+    program += 'n';
+    for (size_t i = 0; i < steps; ++i) {
+      program += ") n)";
+    }
+    program += ')';
+    return program;
+  }
+
+  std::string generateRecursiveCounter(size_t steps) {
+    return "(begin (define count (lambda (n) (if (< n " + std::to_string(steps) +
+           ") (count (+ n 1)) n))) (count 0))";
+  }
+
+  bool run(const char* workload, const std::string& program, size_t steps) {
+    bool ok = true;
+    for (EvaluationEngine engine : {EvaluationEngine::Tree, EvaluationEngine::Bytecode}) {
+      const char* name = engine == EvaluationEngine::Tree ? "tree" : "bytecode";
+      Interpreter interpreter;
+      interpreter.setEngine(engine);
+      interpreter.setDepthLimit(4);
+      std::string source = program;
+      if (!interpreter.parse(source)) {
+        std::cerr << workload << ": failed to parse the counter" << std::endl;
+        return false;
+      }
+
+      try {
+        interpreter.eval(); // Analyzes and compiles the program
+        auto start = std::chrono::steady_clock::now();
+        Expression result = interpreter.eval();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << workload << " (" << name << "): " << steps << " steps in " << seconds * 1e3 << " ms, "
+                  << seconds * 1e9 / steps << " ns/step (" << result << ")" << std::endl;
+        if (!(result == Expression(static_cast<double>(steps)))) {
+          ok = false;
+        }
+      } catch (const InterpreterSemanticError& e) {
+        std::cerr << workload << " (" << name << "): " << e.what() << std::endl;
+        ok = false;
+      }
+    }
+    return ok;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  size_t nested = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+  size_t recursive = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10000000;
+  bool ok = run("nested", generateCounter(nested), nested);
+  ok = run("recursive", generateRecursiveCounter(recursive), recursive) && ok;
+  return ok ? 0 : 1;
+}
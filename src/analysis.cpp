@@ -0,0 +1,421 @@
+#include "analysis.hpp" // Include header file for the analysis pass
+#include "interpreter_semantic_error.hpp" // Include header file for InterpreterSemanticError class
+#include <string>       // Include string library for error messages
+
+namespace {
+
+  /**
+   * Returns the argument count bounds of a special form or builtin procedure. Returns false
+   * for other symbols.
+   */
+  bool arityOf(SymbolId op, uint32_t& minArgs, uint32_t& maxArgs) {
+    switch (op.value) {
+      case SYMBOL_DEFINE:
+        minArgs = maxArgs = 2;
+        return true;
+      case SYMBOL_BEGIN:
+        minArgs = 1;
+        maxArgs = VARIADIC;
+        return true;
+      case SYMBOL_IF:
+        minArgs = maxArgs = 3;
+        return true;
+      case SYMBOL_LAMBDA:
+      case SYMBOL_LET:
+        minArgs = maxArgs = 2;
+        return true;
+      default:
+        break;
+    }
+    const Builtin* builtin = findBuiltin(op);
+    if (builtin == nullptr) {
+      return false;
+    }
+    minArgs = builtin->minArgs;
+    maxArgs = builtin->maxArgs;
+    return true;
+  }
+
+  std::string arguments(uint32_t count) {
+    return std::to_string(count) + (count == 1 ? " argument" : " arguments");
+  }
+
+  /**
+   * Marks a `Scope` that belongs to a `let` form rather than a `lambda` form.
+   */
+  const uint32_t LET_SCOPE = UINT32_MAX;
+
+  /**
+   * A `lambda` or `let` form whose body is being analyzed: the form's node, one past its last
+   * node, its entry in the `LambdaInfo` table (`LET_SCOPE` for `let`), the first node that sees
+   * its variables, and how many slots of the frame are in use inside it.
+   */
+  struct Scope {
+    uint32_t node;
+    uint32_t end;
+    uint32_t lambda;
+    uint32_t body;
+    uint32_t slots;
+  };
+
+  /**
+   * Resolves the variables of the `lambda` and `let` forms being analyzed, innermost last.
+   */
+  class Scopes {
+  public:
+    Scopes(const FlatAst& program, std::vector<LambdaInfo>& lambdas) : program(program), lambdas(lambdas) {}
+
+    /**
+     * Closes the forms that end before `node`, giving back the slots of `let` forms.
+     */
+    void leave(uint32_t node) {
+      while (!scopes.empty() && scopes.back().end <= node) {
+        scopes.pop_back();
+      }
+    }
+
+    /**
+     * Opens the `lambda` form `node`, which is entry `lambda` of the table. Its call frame starts
+     * with the parameters.
+     */
+    void enterLambda(uint32_t node, uint32_t lambda) {
+      uint32_t parameters = node + 2;
+      scopes.push_back(Scope{node, program.ends[node], lambda, program.ends[parameters], program.payloads[parameters]});
+    }
+
+    /**
+     * Opens the `let` form `node`, returning the slot of its first variable. The slots are taken
+     * from here on, so the forms in its values use others, but the variables are only visible
+     * in its body.
+     */
+    uint32_t enterLet(uint32_t node) {
+      uint32_t bindings = node + 2;
+      uint32_t first = scopes.empty() ? 0 : scopes.back().slots;
+      scopes.push_back(Scope{node, program.ends[node], LET_SCOPE, program.ends[bindings],
+                             first + program.payloads[bindings]});
+      return first;
+    }
+
+    /**
+     * Annotates the symbol node `node` as a `Local` or `Captured` variable if some open form
+     * binds it, adding it to the captures of every `lambda` form between the binding one and
+     * the innermost. Leaves `info` alone for variables of the environment.
+     */
+    void resolve(uint32_t node, NodeInfo& info) {
+      SymbolId symbol = program.symbol(node);
+      size_t level = scopes.size();
+      NodeKind kind = NodeKind::Variable;
+      uint32_t index = 0;
+      while (level > 0 && kind == NodeKind::Variable) {
+        --level;
+        if (node >= scopes[level].body) {
+          find(scopes[level], symbol, kind, index);
+        }
+      }
+      if (kind == NodeKind::Variable) {
+        return;
+      }
+      // Each form further in captures the variable from the one around it
+      for (++level; level < scopes.size(); ++level) {
+        if (scopes[level].lambda == LET_SCOPE) {
+          continue; // Part of the same frame
+        }
+        std::vector<Capture>& captures = lambdas[scopes[level].lambda].captures;
+        captures.push_back(Capture{symbol, kind, index});
+        kind = NodeKind::Captured;
+        index = static_cast<uint32_t>(captures.size() - 1);
+      }
+      info.kind = kind;
+      info.index = index;
+    }
+
+  private:
+    /**
+     * Looks `symbol` up among the variables of a `let` scope, or the parameters and captures of
+     * a `lambda` scope.
+     */
+    void find(const Scope& scope, SymbolId symbol, NodeKind& kind, uint32_t& index) const {
+      if (scope.lambda == LET_SCOPE) {
+        uint32_t bindings = scope.node + 2;
+        index = scope.slots - program.payloads[bindings];
+        for (uint32_t binding = bindings + 1; binding < program.ends[bindings]; binding = program.ends[binding]) {
+          if (program.symbol(binding + 1) == symbol) {
+            kind = NodeKind::Local;
+            return;
+          }
+          ++index;
+        }
+        return;
+      }
+      uint32_t parameters = scope.node + 2;
+      index = 0;
+      for (uint32_t parameter = parameters + 1; parameter < program.ends[parameters]; ++parameter, ++index) {
+        if (program.symbol(parameter) == symbol) {
+          kind = NodeKind::Local;
+          return;
+        }
+      }
+      const std::vector<Capture>& captures = lambdas[scope.lambda].captures;
+      for (index = 0; index < captures.size(); ++index) {
+        if (captures[index].symbol == symbol) {
+          kind = NodeKind::Captured;
+          return;
+        }
+      }
+    }
+
+    const FlatAst& program;
+    std::vector<LambdaInfo>& lambdas;
+    std::vector<Scope> scopes;
+  };
+
+  /**
+   * Checks the parameter list of the `lambda` form `node` and marks it as `Parameters`.
+   */
+  void checkParameters(const FlatAst& program, uint32_t node, std::vector<NodeInfo>& nodes) {
+    uint32_t parameters = node + 2;
+    if (program.types[parameters] != AtomType::None) {
+      throw InterpreterSemanticError("Error: lambda requires a list of symbols as its first argument");
+    }
+    for (uint32_t parameter = parameters + 1; parameter < program.ends[parameters]; ++parameter) {
+      if (program.types[parameter] != AtomType::Symbol) {
+        throw InterpreterSemanticError("Error: lambda requires a list of symbols as its first argument");
+      }
+      SymbolId name = program.symbol(parameter);
+      checkDefinable(name);
+      for (uint32_t earlier = parameters + 1; earlier < parameter; ++earlier) {
+        if (program.symbol(earlier) == name) {
+          throw InterpreterSemanticError("Error: lambda parameter " + symbolName(name) + " appears more than once");
+        }
+      }
+      nodes[parameter].kind = NodeKind::Parameters;
+    }
+    nodes[parameters].kind = NodeKind::Parameters;
+  }
+
+  /**
+   * Checks the binding list of the `let` form `node` and marks it, its bindings and their
+   * names as `Parameters`, leaving the values to be analyzed.
+   */
+  void checkBindings(const FlatAst& program, uint32_t node, std::vector<NodeInfo>& nodes) {
+    uint32_t bindings = node + 2;
+    if (program.types[bindings] != AtomType::None) {
+      throw InterpreterSemanticError("Error: let requires a list of (symbol value) pairs as its first argument");
+    }
+    for (uint32_t binding = bindings + 1; binding < program.ends[bindings]; binding = program.ends[binding]) {
+      uint32_t name = binding + 1;
+      if (program.types[binding] != AtomType::None || program.payloads[binding] != 2 ||
+          program.types[name] != AtomType::Symbol) {
+        throw InterpreterSemanticError("Error: let requires a list of (symbol value) pairs as its first argument");
+      }
+      checkDefinable(program.symbol(name));
+      for (uint32_t earlier = bindings + 1; earlier < binding; earlier = program.ends[earlier]) {
+        if (program.symbol(earlier + 1) == program.symbol(name)) {
+          throw InterpreterSemanticError("Error: let variable " + symbolName(program.symbol(name)) +
+                                         " appears more than once");
+        }
+      }
+      nodes[binding].kind = NodeKind::Parameters;
+      nodes[name].kind = NodeKind::Parameters;
+    }
+    nodes[bindings].kind = NodeKind::Parameters;
+  }
+
+  /**
+   * Checks that no list of `program` is nested more than `limit` levels deep, once `nodes` has
+   * been classified.
+   *
+   * The forms are checked as written, before `optimizeProgram` folds any of them away, so both
+   * engines reject the same programs. A list in tail position takes its parent's depth, and the
+   * body of a `lambda` form starts again at depth 1, as it runs in a call of its own.
+   */
+  void checkNesting(const FlatAst& program, const std::vector<NodeInfo>& nodes, size_t limit) {
+    // Set by the parent of each list: its depth, and whether its value is that of a procedure body
+    std::vector<uint32_t> depths(program.size(), 1);
+    std::vector<uint8_t> tails(program.size(), 0);
+    for (uint32_t node = 0; node < program.size(); ++node) {
+      if (program.types[node] != AtomType::None || nodes[node].kind == NodeKind::Parameters) {
+        continue;
+      }
+      uint32_t depth = depths[node];
+      checkDepth(depth, limit);
+      uint32_t first = node + 1;
+      auto nest = [&](uint32_t child, bool tail) {
+        depths[child] = tail ? depth : depth + 1;
+        tails[child] = tail && tails[node];
+      };
+      switch (nodes[node].kind) {
+        case NodeKind::Begin:
+          for (uint32_t child = program.ends[first]; child < program.ends[node]; child = program.ends[child]) {
+            nest(child, program.ends[child] == program.ends[node]);
+          }
+          break;
+        case NodeKind::If: {
+          uint32_t condition = program.ends[first];
+          uint32_t consequent = program.ends[condition];
+          nest(condition, false);
+          nest(consequent, true);
+          nest(program.ends[consequent], true);
+          break;
+        }
+        case NodeKind::Let: {
+          uint32_t bindings = program.ends[first];
+          for (uint32_t binding = bindings + 1; binding < program.ends[bindings]; binding = program.ends[binding]) {
+            nest(program.ends[binding + 1], false);
+          }
+          // Only a procedure body leaves the variables unbound in the form's place
+          nest(program.ends[bindings], tails[node] != 0);
+          break;
+        }
+        case NodeKind::Lambda: {
+          uint32_t body = program.ends[node + 2];
+          depths[body] = 1;
+          tails[body] = 1;
+          break;
+        }
+        default:
+          for (uint32_t child = first; child < program.ends[node]; child = program.ends[child]) {
+            nest(child, false);
+          }
+          break;
+      }
+    }
+  }
+}
+
+/**
+ * Throws unless `count` arguments are acceptable for the special form or builtin `op`.
+ */
+void checkArity(SymbolId op, size_t count) {
+  uint32_t minArgs;
+  uint32_t maxArgs;
+  if (!arityOf(op, minArgs, maxArgs)) {
+    throw InterpreterSemanticError("Error: unknown procedure " + symbolName(op));
+  }
+  if (count >= minArgs && count <= maxArgs) {
+    return;
+  }
+
+  std::string expected;
+  if (minArgs == maxArgs) {
+    expected = "exactly " + arguments(minArgs);
+  } else if (maxArgs == VARIADIC) {
+    expected = "at least " + arguments(minArgs);
+  } else {
+    expected = "between " + std::to_string(minArgs) + " and " + arguments(maxArgs);
+  }
+  throw InterpreterSemanticError("Error: " + symbolName(op) + " requires " + expected);
+}
+
+/**
+ * Throws unless `define` may give `name` a value.
+ */
+void checkDefinable(SymbolId name) {
+  if (isPredefinedSymbol(name)) {
+    throw InterpreterSemanticError("Error: cannot redefine builtin symbol " + symbolName(name));
+  }
+}
+
+/**
+ * Throws if a list nested `depth` levels deep exceeds `limit`.
+ */
+void checkDepth(size_t depth, size_t limit) {
+  if (depth > limit) {
+    throw InterpreterSemanticError("Error: program is nested more than " + std::to_string(limit) +
+                                   " levels deep");
+  }
+}
+
+/**
+ * Annotates every node of `program`.
+ *
+ * Nodes are visited in storage order, which is pre-order, so no recursion is needed. A list
+ * is classified by its first child: special forms and builtins are recognised by symbol id.
+ * The `lambda` and `let` forms around the node being visited are kept on a stack of scopes,
+ * against which its symbols are resolved. Nesting is checked once every node is classified.
+ */
+void analyzeProgram(const FlatAst& program, std::vector<NodeInfo>& nodes, std::vector<LambdaInfo>& lambdas,
+                    size_t depthLimit) {
+  nodes.assign(program.size(), NodeInfo{NodeKind::Literal, 0, nullptr});
+  lambdas.clear();
+  Scopes scopes(program, lambdas);
+  uint32_t definedName = 0; // The name given to the last define, which is not evaluated
+  for (uint32_t node = 0; node < program.size(); ++node) {
+    NodeInfo& info = nodes[node];
+    scopes.leave(node);
+    if (info.kind == NodeKind::Parameters) {
+      continue;
+    }
+    if (program.types[node] == AtomType::Symbol) {
+      info.kind = NodeKind::Variable;
+      if (node != definedName) {
+        scopes.resolve(node, info);
+      }
+      continue;
+    }
+    if (program.types[node] != AtomType::None) {
+      continue; // Literal
+    }
+
+    info.kind = NodeKind::Apply;
+    uint32_t first = node + 1;
+    if (first == program.ends[node]) {
+      // Empty lists are only read as parameter and binding lists, which were marked above
+      throw InterpreterSemanticError("Error: cannot apply an empty list");
+    }
+    if (program.types[first] != AtomType::Symbol) {
+      continue;
+    }
+
+    SymbolId op = program.symbol(first);
+    size_t count = program.payloads[node] - 1;
+    switch (op.value) {
+      case SYMBOL_DEFINE: {
+        checkArity(op, count);
+        uint32_t name = program.ends[first];
+        if (program.types[name] != AtomType::Symbol) {
+          throw InterpreterSemanticError("Error: define requires a symbol as its first argument");
+        }
+        checkDefinable(program.symbol(name));
+        info.kind = NodeKind::Define;
+        definedName = name;
+        break;
+      }
+      case SYMBOL_BEGIN:
+        checkArity(op, count);
+        info.kind = NodeKind::Begin;
+        break;
+      case SYMBOL_IF:
+        checkArity(op, count);
+        info.kind = NodeKind::If;
+        break;
+      case SYMBOL_LAMBDA:
+        checkArity(op, count);
+        checkParameters(program, node, nodes);
+        info.kind = NodeKind::Lambda;
+        info.index = static_cast<uint32_t>(lambdas.size());
+        lambdas.emplace_back();
+        scopes.enterLambda(node, info.index);
+        break;
+      case SYMBOL_LET:
+        checkArity(op, count);
+        checkBindings(program, node, nodes);
+        info.kind = NodeKind::Let;
+        info.index = scopes.enterLet(node);
+        break;
+      case SYMBOL_AND:
+      case SYMBOL_OR:
+        checkArity(op, count);
+        info.kind = op.value == SYMBOL_AND ? NodeKind::And : NodeKind::Or;
+        break;
+      default:
+        if (const Builtin* builtin = findBuiltin(op)) {
+          checkArity(op, count);
+          info.kind = NodeKind::BuiltinCall;
+          info.procedure = builtin->procedure;
+        }
+        break;
+    }
+  }
+  checkNesting(program, nodes, depthLimit);
+}
@@ -0,0 +1,136 @@
+#ifndef ANALYSIS_HPP // Prevent multiple inclusions
+#define ANALYSIS_HPP   // Define a unique identifier for the header file
+
+#include <cstddef>          // Include cstddef for size_t
+#include <cstdint>          // Include cstdint for the node kinds
+#include <vector>           // Include vector for the node annotations
+#include "builtins.hpp"     // Include header file for Builtin
+#include "flat_ast.hpp"     // Include header file for FlatAst class
+#include "symbol_table.hpp" // Include header file for SymbolId
+
+/**
+ * This header file defines the semantic analysis pass, which runs once over a parsed program
+ * and records what each node is, so that evaluation never has to work it out again.
+ */
+
+/**
+ * Default limit on how deeply the lists of a program may be nested (see `checkDepth`).
+ *
+ * The evaluators keep their own stacks on the heap, so the limit does not protect the C++ stack;
+ * it bounds the memory and time a single program can claim.
+ */
+const size_t DEFAULT_DEPTH_LIMIT = 1 << 20;
+
+/**
+ * What a node of a program does when it is evaluated.
+ *
+ *  - Literal: a number or boolean, which evaluates to itself.
+ *  - Variable: a symbol, which evaluates to its value in the environment.
+ *  - Define / Begin / If: a list headed by the special form of the same name.
+ *  - And / Or: a list headed by `and` or `or`. These are builtin procedures, but their operands
+ *    are evaluated from left to right only until one decides the result.
+ *  - BuiltinCall: a list headed by the name of a builtin procedure.
+ *  - Apply: any other list. What it does depends on the value of its first element, which is
+ *    only known while evaluating.
+ *  - Lambda: a list headed by `lambda`, which evaluates to a procedure. Its `index` is the
+ *    procedure's entry in the `LambdaInfo` table.
+ *  - Let: a list headed by `let`, which binds variables for the evaluation of its body. Its
+ *    `index` is the frame slot of its first variable (see `Local`).
+ *  - Parameters: the parameter list of a `lambda` form, the binding list of a `let` form and
+ *    the bindings and symbols in them, which are never evaluated as such.
+ *  - Local: a symbol naming a variable of the frame being run: a parameter of the innermost
+ *    enclosing `lambda` or a variable bound by a `let` inside it (or, outside every `lambda`, by
+ *    a `let` of the program). Its `index` is the variable's slot in the frame, the parameters
+ *    coming first.
+ *  - Captured: a symbol naming a variable of some further enclosing frame. Its `index` is its
+ *    slot in the closure of the innermost `lambda` (see `LambdaInfo`).
+ *
+ * The optimizer (see `optimizeProgram`) rewrites nodes into two more kinds:
+ *  - Constant: a node whose value is known without running the program.
+ *  - Alias: a node whose value is the value of another node of its subtree, which is evaluated
+ *    in its place.
+ */
+enum class NodeKind : uint8_t {
+  Literal, Variable, Define, Begin, If, And, Or, BuiltinCall, Apply, Lambda, Let, Parameters, Local,
+  Captured, Constant, Alias
+};
+
+/**
+ * The analysis result for one node: its kind, for `Constant` and `Alias` nodes an index (into
+ * the optimizer's constants, or of the node evaluated instead), for `Lambda`, `Let`, `Local`
+ * and `Captured` nodes the index described with their kind, and for `BuiltinCall` nodes the
+ * procedure.
+ */
+struct NodeInfo {
+  NodeKind kind;
+  uint32_t index;
+  BuiltinProcedure procedure;
+};
+
+/**
+ * A variable a closure captures: `symbol`, found in the scope around its `lambda` form as a
+ * `Local` or `Captured` variable (`kind`) at `index`.
+ */
+struct Capture {
+  SymbolId symbol;
+  NodeKind kind;
+  uint32_t index;
+};
+
+/**
+ * The analysis result for one `lambda` form: the variables its closures capture, in slot order.
+ * A form captures the variables of enclosing forms that its body, or any form inside it, uses.
+ */
+struct LambdaInfo {
+  std::vector<Capture> captures;
+};
+
+/**
+ * Annotates every node of `program`, replacing the contents of `nodes` (one entry per node)
+ * and of `lambdas` (one entry per `lambda` form, in pre-order).
+ *
+ * Special forms and builtin calls are checked here, before anything is evaluated: their
+ * argument counts must match (see `checkArity`), `define` must be given a symbol that is
+ * not predefined, `lambda` a list of distinct such symbols, and `let` a list of `(symbol value)`
+ * pairs naming distinct such symbols, and no list may be nested more than `depthLimit` levels
+ * deep (see `checkDepth`). Problems are reported by throwing an `InterpreterSemanticError`.
+ *
+ * Scopes are lexical: a symbol inside a `lambda` form refers to the parameter of that name of
+ * the innermost form around it that has one, and a symbol in the body of a `let` form to its
+ * variable of that name, whichever form is nearer. Every other symbol is a variable of the
+ * environment, including those given a value by `define` inside a procedure.
+ *
+ * Each scope is resolved to slots of a frame rather than looked up by name: a procedure call
+ * has one frame, holding its parameters followed by the variables of the `let` forms in its
+ * body, and the program outside every `lambda` has one for its own `let` forms. A `let` takes
+ * the slots after those of the forms around it and gives them back when it ends, so however
+ * deeply scopes nest, a variable is read from a known slot in constant time.
+ */
+void analyzeProgram(const FlatAst& program, std::vector<NodeInfo>& nodes, std::vector<LambdaInfo>& lambdas,
+                    size_t depthLimit);
+
+/**
+ * Throws an `InterpreterSemanticError` unless `count` arguments are acceptable for the special
+ * form or builtin procedure `op`. Other symbols are not procedures, so calling them is an error.
+ *
+ * The evaluators use this for calls that could not be checked in advance, where the procedure
+ * is only known once the first element of a list has been evaluated.
+ */
+void checkArity(SymbolId op, size_t count);
+
+/**
+ * Throws an `InterpreterSemanticError` unless `define` may give `name` a value.
+ */
+void checkDefinable(SymbolId name);
+
+/**
+ * Throws an `InterpreterSemanticError` if a list nested `depth` levels deep (the outermost list
+ * being at depth 1) exceeds `limit`.
+ *
+ * A list in tail position, a branch of `if` or the last operand of `begin` (and the body of a
+ * `let` in tail position of a procedure body), is at the same depth as the form it belongs to:
+ * it takes the form's place, so chains of such lists of any length evaluate within the limit.
+ */
+void checkDepth(size_t depth, size_t limit);
+
+#endif // ANALYSIS_HPP // Guard against multiple inclusions
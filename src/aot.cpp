@@ -0,0 +1,477 @@
+#include "aot.hpp"                        // Include header file for the translator
+#include "interpreter_semantic_error.hpp" // Include header file for InterpreterSemanticError class
+#include <algorithm>                      // Include algorithm for max
+#include <cmath>                          // Include cmath for isnan and isinf
+#include <iomanip>                        // Include iomanip for setprecision
+#include <limits>                         // Include limits for the digits of a double
+#include <sstream>                        // Include sstream for building the statements
+#include <unordered_map>                  // Include unordered_map for the symbol table
+#include <vector>                         // Include vector for the stack depths
+
+namespace {
+
+  /**
+   * Depths of the value stack and the number stack before an instruction, or -1 for an
+   * instruction that is never reached.
+   */
+  struct Depth {
+    int32_t values;
+    int32_t numbers;
+  };
+
+  /**
+   * Returns a C++ expression for `value`, which reads back as exactly the same double.
+   */
+  std::string numberLiteral(double value) {
+    if (std::isnan(value)) {
+      return "std::numeric_limits<double>::quiet_NaN()";
+    }
+    if (std::isinf(value)) {
+      return value > 0 ? "std::numeric_limits<double>::infinity()" : "-std::numeric_limits<double>::infinity()";
+    }
+    std::ostringstream literal;
+    literal << std::setprecision(std::numeric_limits<double>::max_digits10) << value;
+    std::string text = literal.str();
+    if (text.find_first_of(".e") == std::string::npos) {
+      text += ".0";
+    }
+    return text;
+  }
+
+  /**
+   * Returns `text` as a C++ string literal.
+   */
+  std::string stringLiteral(const std::string& text) {
+    std::string literal = "\"";
+    for (char c : text) {
+      if (c == '"' || c == '\\') {
+        literal += '\\';
+      }
+      literal += c;
+    }
+    return literal + "\"";
+  }
+
+  /**
+   * Translates a compiled program into the body of a C++ function (see `translateProgram`).
+   */
+  class Translator {
+  public:
+    Translator(const Bytecode& code) : code(code), valueSlots(1), numberSlots(0) {}
+
+    void translate(const std::string& function, std::ostream& source) {
+      if (!code.lambdas.empty()) {
+        // A closure runs bytecode, which a translated program does not carry
+        throw InterpreterSemanticError("Error: cannot translate a program that uses lambda");
+      }
+      computeDepths();
+      for (uint32_t index = 0; index < code.instructions.size(); ++index) {
+        if (depths[index].values >= 0) {
+          translateInstruction(index);
+        }
+      }
+
+      source << "// Generated by slisp-aot from a Slisp program. Do not edit.\n"
+             << "#include \"aot_runtime.hpp\"\n\n"
+             << "Expression " << function << "(Environment& environment) {\n";
+      if (!symbols.empty()) {
+        source << "  static const SymbolId symbols[] = {";
+        for (size_t i = 0; i < symbols.size(); ++i) {
+          source << (i == 0 ? "" : ", ") << "internSymbol(" << stringLiteral(symbolName(symbols[i])) << ")";
+        }
+        source << "};\n";
+      }
+      source << "  std::vector<Expression> stack(" << valueSlots << ");\n"
+             << "  Expression* s = stack.data();\n";
+      for (int32_t slot = 0; slot < numberSlots; ++slot) {
+        // A program need not use every register, just as it need not use `environment`
+        source << "  double n" << slot << " = 0;\n"
+               << "  static_cast<void>(n" << slot << ");\n";
+      }
+      source << "  static_cast<void>(environment);\n"
+             << body.str();
+      if (code.instructions.empty()) {
+        source << "  return Expression();\n"; // An empty program evaluates to nothing
+      }
+      source << "}\n";
+    }
+
+  private:
+    /**
+     * Works out the stack depths before every instruction, following every jump.
+     */
+    void computeDepths() {
+      depths.assign(code.instructions.size(), Depth{-1, -1});
+      targets.assign(code.instructions.size(), false);
+      if (code.instructions.empty()) {
+        return;
+      }
+      reach(0, Depth{static_cast<int32_t>(code.frameSize), 0}); // Above the slots of `let` variables
+      while (!pending.empty()) {
+        uint32_t index = pending.back();
+        pending.pop_back();
+        const Instruction& instruction = code.instructions[index];
+        Depth depth = depths[index];
+        int32_t count = static_cast<int32_t>(instruction.count);
+        uint32_t next = index + 1;
+        switch (instruction.opcode) {
+          case Opcode::PushConstant:
+          case Opcode::LoadVariable:
+            reach(next, Depth{depth.values + 1, depth.numbers});
+            break;
+          case Opcode::Define:
+            reach(next, Depth{depth.values - (count == 1 ? 1 : 0), depth.numbers});
+            break;
+          case Opcode::Pop:
+            reach(next, Depth{depth.values - 1, depth.numbers});
+            break;
+          case Opcode::Jump:
+            jumpTo(instruction.operand, depth);
+            break;
+          case Opcode::JumpIfFalse:
+            reach(next, Depth{depth.values - 1, depth.numbers});
+            jumpTo(instruction.operand, Depth{depth.values - 1, depth.numbers});
+            break;
+          case Opcode::CallBuiltin:
+          case Opcode::Apply:
+            reach(next, Depth{depth.values - count + 1, depth.numbers});
+            break;
+          case Opcode::LoadLocal:
+            reach(next, Depth{depth.values + 1, depth.numbers});
+            break;
+          case Opcode::StoreLocal:
+            reach(next, Depth{depth.values - 1, depth.numbers});
+            break;
+          case Opcode::LoadCaptured:
+          case Opcode::TailApply:
+          case Opcode::MakeClosure:
+            break; // Only in programs with `lambda`, which are rejected
+
+          case Opcode::Add:
+          case Opcode::Subtract:
+          case Opcode::Multiply:
+          case Opcode::Divide:
+          case Opcode::Less:
+          case Opcode::LessEqual:
+          case Opcode::Greater:
+          case Opcode::GreaterEqual:
+          case Opcode::Equal:
+          case Opcode::Power:
+            // With a constant right operand, the constant needs a slot of its own
+            valueSlots = std::max(valueSlots, depth.values + 1);
+            reach(next, Depth{depth.values - (count == 2 ? 1 : 0), depth.numbers});
+            break;
+          case Opcode::And:
+          case Opcode::Or:
+            jumpTo(instruction.operand, depth);
+            reach(next, Depth{depth.values - (count == 0 ? 1 : 0), depth.numbers});
+            break;
+          case Opcode::LoadNumber:
+            jumpTo(instruction.count, Depth{depth.values, 0});
+            reach(next, Depth{depth.values, depth.numbers + 1});
+            break;
+          case Opcode::PushNumber:
+          case Opcode::LoadProvenNumber:
+            reach(next, Depth{depth.values, depth.numbers + 1});
+            break;
+          case Opcode::Unbox:
+            reach(next, Depth{depth.values - 1, depth.numbers + 1});
+            break;
+          case Opcode::AddNumbers:
+          case Opcode::SubtractNumbers:
+          case Opcode::MultiplyNumbers:
+            reach(next, Depth{depth.values, depth.numbers - count + 1});
+            break;
+          case Opcode::DivideNumbers:
+          case Opcode::PowerNumbers:
+            reach(next, Depth{depth.values, depth.numbers - 1});
+            break;
+          case Opcode::Log10Number:
+          case Opcode::EnterRegion:
+            reach(next, depth);
+            break;
+          case Opcode::LessNumbers:
+          case Opcode::LessEqualNumbers:
+          case Opcode::GreaterNumbers:
+          case Opcode::GreaterEqualNumbers:
+          case Opcode::EqualNumbers:
+            reach(next, Depth{depth.values + 1, depth.numbers - 2});
+            break;
+          case Opcode::Box:
+            reach(next, Depth{depth.values + 1, depth.numbers - 1});
+            break;
+          case Opcode::Return:
+            break;
+        }
+      }
+    }
+
+    void jumpTo(uint32_t target, Depth depth) {
+      targets[target] = true;
+      reach(target, depth);
+    }
+
+    void reach(uint32_t index, Depth depth) {
+      if (depths[index].values >= 0) {
+        if (depths[index].values != depth.values || depths[index].numbers != depth.numbers) {
+          throw InterpreterSemanticError("Error: cannot translate a program whose stack depth varies");
+        }
+        return;
+      }
+      depths[index] = depth;
+      valueSlots = std::max(valueSlots, depth.values + 1);
+      numberSlots = std::max(numberSlots, depth.numbers + 1);
+      pending.push_back(index);
+    }
+
+    void translateInstruction(uint32_t index) {
+      const Instruction& instruction = code.instructions[index];
+      int32_t values = depths[index].values;
+      int32_t numbers = depths[index].numbers;
+      uint32_t count = instruction.count;
+      if (targets[index]) {
+        body << "L" << index << ":;\n";
+      }
+
+      switch (instruction.opcode) {
+        case Opcode::PushConstant:
+          line() << slot(values) << " = " << constant(code.constants[instruction.operand]) << ";\n";
+          break;
+        case Opcode::LoadVariable:
+          line() << "aotLoadVariable(environment, " << symbol(SymbolId{instruction.operand}) << ", "
+                 << slot(values) << ");\n";
+          break;
+        case Opcode::Define:
+          line() << "aotDefine(environment, " << symbol(SymbolId{instruction.operand}) << ", " << slot(values - 1)
+                 << ", " << (count == 1 ? "true" : "false") << ");\n";
+          break;
+        case Opcode::Pop:
+          break;
+        case Opcode::Jump:
+          line() << "goto L" << instruction.operand << ";\n";
+          break;
+        case Opcode::JumpIfFalse:
+          line() << "if (!aotCondition(" << slot(values - 1) << ")) goto L" << instruction.operand << ";\n";
+          break;
+        case Opcode::CallBuiltin:
+          line() << "aotCallBuiltin(" << symbol(builtinName(code.procedures[instruction.operand])) << ", s + "
+                 << values - static_cast<int32_t>(count) << ", " << count << ");\n";
+          break;
+        case Opcode::Apply:
+          line() << "aotApply(environment, s + " << values - static_cast<int32_t>(count) << ", " << count << ");\n";
+          break;
+        case Opcode::LoadLocal:
+          line() << slot(values) << " = " << slot(static_cast<int32_t>(instruction.operand)) << ";\n";
+          break;
+        case Opcode::StoreLocal:
+          line() << slot(static_cast<int32_t>(instruction.operand)) << " = std::move(" << slot(values - 1) << ");\n";
+          break;
+        case Opcode::LoadCaptured:
+        case Opcode::TailApply:
+        case Opcode::MakeClosure:
+          break; // Rejected by translate()
+        case Opcode::Add: binary(instruction, values, SymbolId{SYMBOL_ADD}, "0.0 + ", " + ", ""); break;
+        case Opcode::Subtract: binary(instruction, values, SymbolId{SYMBOL_SUBTRACT}, "", " - ", ""); break;
+        case Opcode::Multiply: binary(instruction, values, SymbolId{SYMBOL_MULTIPLY}, "", " * ", ""); break;
+        case Opcode::Divide: binary(instruction, values, SymbolId{SYMBOL_DIVIDE}, "", " / ", ""); break;
+        case Opcode::Less: binary(instruction, values, SymbolId{SYMBOL_LESS}, "", " < ", ""); break;
+        case Opcode::LessEqual: binary(instruction, values, SymbolId{SYMBOL_LESS_EQUAL}, "", " <= ", ""); break;
+        case Opcode::Greater: binary(instruction, values, SymbolId{SYMBOL_GREATER}, "", " > ", ""); break;
+        case Opcode::GreaterEqual: binary(instruction, values, SymbolId{SYMBOL_GREATER_EQUAL}, "", " >= ", ""); break;
+        case Opcode::Equal: binary(instruction, values, SymbolId{SYMBOL_EQUAL}, "", " == ", ""); break;
+        case Opcode::Power: binary(instruction, values, SymbolId{SYMBOL_POW}, "aotPower(", ", ", ")"); break;
+        case Opcode::And:
+        case Opcode::Or:
+          line() << "if (aotDecides(" << slot(values - 1) << ", "
+                 << (instruction.opcode == Opcode::And ? "false, \"and\"" : "true, \"or\"") << ")) goto L"
+                 << instruction.operand << ";\n";
+          break;
+        case Opcode::PushNumber:
+          line() << number(numbers) << " = " << numberLiteral(code.numbers[instruction.operand]) << ";\n";
+          break;
+        case Opcode::LoadNumber:
+          line() << "if (!aotLoadNumber(environment, " << symbol(SymbolId{instruction.operand}) << ", "
+                 << number(numbers) << ")) goto L" << count << ";\n";
+          break;
+        case Opcode::LoadProvenNumber:
+          line() << number(numbers) << " = environment.find(" << symbol(SymbolId{instruction.operand})
+                 << ")->numValue;\n";
+          break;
+        case Opcode::Unbox:
+          line() << number(numbers) << " = " << slot(values - 1) << ".numValue;\n";
+          break;
+        case Opcode::AddNumbers:
+        case Opcode::MultiplyNumbers: {
+          // Folded from the builtin's initial value, in order, so the rounding is the same
+          int32_t base = numbers - static_cast<int32_t>(count);
+          bool add = instruction.opcode == Opcode::AddNumbers;
+          line() << number(base) << " = " << (add ? "0.0" : "1.0");
+          for (int32_t operand = base; operand < numbers; ++operand) {
+            body << (add ? " + " : " * ") << number(operand);
+          }
+          body << ";\n";
+          break;
+        }
+        case Opcode::SubtractNumbers:
+          if (count == 1) {
+            line() << number(numbers - 1) << " = -" << number(numbers - 1) << ";\n";
+          } else {
+            line() << number(numbers - 2) << " = " << number(numbers - 2) << " - " << number(numbers - 1) << ";\n";
+          }
+          break;
+        case Opcode::DivideNumbers:
+          line() << "if (" << number(numbers - 1) << " == 0) aotDivisionByZero();\n";
+          line() << number(numbers - 2) << " = " << number(numbers - 2) << " / " << number(numbers - 1) << ";\n";
+          break;
+        case Opcode::PowerNumbers:
+          line() << number(numbers - 2) << " = aotPower(" << number(numbers - 2) << ", " << number(numbers - 1)
+                 << ");\n";
+          break;
+        case Opcode::Log10Number:
+          line() << number(numbers - 1) << " = std::log10(" << number(numbers - 1) << ");\n";
+          break;
+        case Opcode::LessNumbers: compare(values, numbers, "<"); break;
+        case Opcode::LessEqualNumbers: compare(values, numbers, "<="); break;
+        case Opcode::GreaterNumbers: compare(values, numbers, ">"); break;
+        case Opcode::GreaterEqualNumbers: compare(values, numbers, ">="); break;
+        case Opcode::EqualNumbers: compare(values, numbers, "=="); break;
+        case Opcode::Box:
+          line() << slot(values) << " = Expression(" << number(numbers - 1) << ");\n";
+          break;
+        case Opcode::EnterRegion:
+          break; // Only marks the region for the JIT
+        case Opcode::Return:
+          line() << "return std::move(" << slot(values - 1) << ");\n";
+          break;
+      }
+    }
+
+    /**
+     * Translates an inline binary operation, computing `before` a `between` b `after` when both
+     * operands are numbers and calling the builtin `op` otherwise, as the virtual machine does.
+     */
+    void binary(const Instruction& instruction, int32_t values, SymbolId op, const char* before,
+                const char* between, const char* after) {
+      int32_t left = values - static_cast<int32_t>(instruction.count);
+      std::string a = slot(left) + ".numValue";
+      std::string b = slot(left + 1) + ".numValue";
+      if (instruction.count == 1) {
+        line() << slot(values) << " = " << constant(code.constants[instruction.operand]) << ";\n";
+      }
+      line() << "if (aotNumbers(" << slot(left) << ", " << slot(left + 1) << ")"
+             << (op.value == SYMBOL_DIVIDE ? " && " + b + " != 0" : "") << ") {\n";
+      line() << "  " << slot(left) << " = Expression(" << before << a << between << b << after << ");\n";
+      line() << "} else {\n";
+      line() << "  aotCallBuiltin(" << symbol(op) << ", s + " << left << ", 2);\n";
+      line() << "}\n";
+    }
+
+    void compare(int32_t values, int32_t numbers, const char* comparison) {
+      line() << slot(values) << " = Expression(" << number(numbers - 2) << " " << comparison << " "
+             << number(numbers - 1) << ");\n";
+    }
+
+    std::ostream& line() {
+      return body << "  ";
+    }
+
+    std::string slot(int32_t index) const {
+      return "s[" + std::to_string(index) + "]";
+    }
+
+    std::string number(int32_t index) const {
+      return "n" + std::to_string(index);
+    }
+
+    /**
+     * Returns the expression naming `id` in the generated code. Symbols are interned again by
+     * name when the function first runs, since ids differ from one process to the next.
+     */
+    std::string symbol(SymbolId id) {
+      auto found = symbolIndex.find(id.value);
+      if (found == symbolIndex.end()) {
+        found = symbolIndex.emplace(id.value, static_cast<uint32_t>(symbols.size())).first;
+        symbols.push_back(id);
+      }
+      return "symbols[" + std::to_string(found->second) + "]";
+    }
+
+    std::string constant(const Expression& value) {
+      switch (value.type) {
+        case AtomType::Number: return "Expression(" + numberLiteral(value.numValue) + ")";
+        case AtomType::Boolean: return value.boolValue ? "Expression(true)" : "Expression(false)";
+        case AtomType::Symbol: return "Expression(" + symbol(value.symbol) + ")";
+        default: break;
+      }
+      throw InterpreterSemanticError("Error: cannot translate a list constant");
+    }
+
+    /**
+     * Returns the symbol naming the builtin `procedure`.
+     */
+    static SymbolId builtinName(BuiltinProcedure procedure) {
+      for (uint32_t id = FIRST_BUILTIN_PROCEDURE; id < PREDEFINED_SYMBOL_COUNT; ++id) {
+        if (findBuiltin(SymbolId{id})->procedure == procedure) {
+          return SymbolId{id};
+        }
+      }
+      throw InterpreterSemanticError("Error: cannot translate a call of an unknown procedure");
+    }
+
+    const Bytecode& code;
+    std::vector<Depth> depths;
+    std::vector<bool> targets; // Whether an instruction is the target of a jump, and needs a label
+    std::vector<uint32_t> pending;
+    int32_t valueSlots;
+    int32_t numberSlots;
+    std::vector<SymbolId> symbols;
+    std::unordered_map<uint32_t, uint32_t> symbolIndex;
+    std::ostringstream body;
+  };
+}
+
+/**
+ * Checks whether `name` can be used as the name of a translated function.
+ */
+bool isTranslatableName(const std::string& name) {
+  if (name.empty() || (name[0] >= '0' && name[0] <= '9')) {
+    return false;
+  }
+  for (char c : name) {
+    bool letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    if (!letter && !(c >= '0' && c <= '9')) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Writes the C++ translation unit for a compiled program.
+ */
+void translateProgram(const Bytecode& code, const std::string& function, std::ostream& source) {
+  Translator translator(code);
+  translator.translate(function, source);
+}
+
+/**
+ * Writes the header declaring a translated program.
+ */
+void translateHeader(const std::string& function, std::ostream& header) {
+  std::string guard = function;
+  for (char& c : guard) {
+    c = static_cast<char>(c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c);
+  }
+  guard += "_HPP";
+  header << "// Generated by slisp-aot from a Slisp program. Do not edit.\n"
+         << "#ifndef " << guard << " // Prevent multiple inclusions\n"
+         << "#define " << guard << "\n\n"
+         << "#include \"environment.hpp\" // Include header file for Environment class\n"
+         << "#include \"expression.hpp\"  // Include header file for Expression class\n\n"
+         << "/**\n"
+         << " * Evaluates the translated program in `environment` and returns its value, throwing an\n"
+         << " * `InterpreterSemanticError` where the interpreter would.\n"
+         << " */\n"
+         << "Expression " << function << "(Environment& environment);\n\n"
+         << "#endif // " << guard << "\n";
+}
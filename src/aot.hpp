@@ -0,0 +1,43 @@
+#ifndef AOT_HPP // Prevent multiple inclusions
+#define AOT_HPP   // Define a unique identifier for the header file
+
+#include <ostream>        // Include ostream for the generated source
+#include <string>         // Include string library for the function name
+#include "bytecode.hpp"   // Include header file for Bytecode
+
+/**
+ * This header file defines the ahead-of-time translator behind `slisp-aot`, which turns a
+ * compiled program into C++ source, so a script that never changes can be built into a native
+ * library instead of being interpreted on every run.
+ */
+
+/**
+ * Checks whether `name` can be used as the name of a translated function: a C++ identifier.
+ */
+bool isTranslatableName(const std::string& name);
+
+/**
+ * Writes a C++ translation unit defining
+ *
+ *   Expression function(Environment& environment);
+ *
+ * which evaluates the program compiled into `code` in `environment`, with the same result and
+ * the same `InterpreterSemanticError`s as the interpreter. The source includes
+ * `aot_runtime.hpp` and links against the interpreter library.
+ *
+ * Every instruction becomes a few statements: the stack depth before each instruction is known
+ * when translating, so the value stack becomes an array indexed by constants (starting with the
+ * slots of the variables of `let` forms), the number stack of numeric regions becomes local
+ * doubles, and jumps become `goto`s. `code` must have been
+ * compiled with types inferred against a fresh environment, since the translated function may
+ * be called with any environment. Programs using `lambda` are not translated: an
+ * `InterpreterSemanticError` is thrown instead.
+ */
+void translateProgram(const Bytecode& code, const std::string& function, std::ostream& source);
+
+/**
+ * Writes the header declaring the function written by `translateProgram`.
+ */
+void translateHeader(const std::string& function, std::ostream& header);
+
+#endif // AOT_HPP // Guard against multiple inclusions
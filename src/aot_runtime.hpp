@@ -0,0 +1,113 @@
+#ifndef AOT_RUNTIME_HPP // Prevent multiple inclusions
+#define AOT_RUNTIME_HPP   // Define a unique identifier for the header file
+
+#include <cmath>            // Include cmath for pow and log10
+#include <cstddef>          // Include cstddef for size_t
+#include <limits>           // Include limits for infinite and NaN constants
+#include <utility>          // Include utility for std::move
+#include <vector>           // Include vector for the value stack of a translated program
+#include "builtins.hpp"     // Include header file for findBuiltin
+#include "environment.hpp"  // Include header file for Environment class
+#include "expression.hpp"   // Include header file for Expression class
+#include "interpreter_semantic_error.hpp" // Include header file for InterpreterSemanticError class
+#include "symbol_table.hpp" // Include header file for SymbolId
+#include "vm.hpp"           // Include header file for applyList
+
+/**
+ * This header file defines the helpers used by the C++ code that `slisp-aot` generates (see
+ * `translateProgram`). Each one does what the virtual machine does for the matching opcode, so
+ * a translated program behaves exactly as the interpreter would.
+ */
+
+/**
+ * Stores the value of `symbol` in `slot`, or the symbol itself when it is not defined.
+ */
+inline void aotLoadVariable(const Environment& environment, SymbolId symbol, Expression& slot) {
+  const Expression* bound = environment.find(symbol);
+  if (bound != nullptr) {
+    slot = *bound;
+  } else {
+    slot = Expression(symbol);
+  }
+}
+
+/**
+ * Binds `symbol` to `value`, moving it into the environment when the value is discarded.
+ */
+inline void aotDefine(Environment& environment, SymbolId symbol, Expression& value, bool discarded) {
+  if (discarded) {
+    environment.addSymbol(symbol, std::move(value));
+  } else {
+    environment.addSymbol(symbol, value);
+  }
+}
+
+/**
+ * Returns the condition of an `if`, which must be a boolean.
+ */
+inline bool aotCondition(const Expression& value) {
+  if (value.type != AtomType::Boolean) {
+    throw InterpreterSemanticError("Error: if requires a boolean condition");
+  }
+  return value.boolValue;
+}
+
+/**
+ * Checks an operand of `and` or `or` (`name`), returning whether it equals `decisive`.
+ */
+inline bool aotDecides(const Expression& value, bool decisive, const char* name) {
+  if (value.type != AtomType::Boolean) {
+    throw InterpreterSemanticError(std::string("Error: ") + name + " requires boolean arguments");
+  }
+  return value.boolValue == decisive;
+}
+
+/**
+ * Checks whether both operands of an inline operation are numbers.
+ */
+inline bool aotNumbers(const Expression& left, const Expression& right) {
+  return left.type == AtomType::Number && right.type == AtomType::Number;
+}
+
+/**
+ * Calls the builtin procedure `op` on the `count` values at `args`, storing the result in the
+ * first of them.
+ */
+inline void aotCallBuiltin(SymbolId op, Expression* args, size_t count) {
+  Expression value;
+  findBuiltin(op)->procedure(args, count, value);
+  args[0] = std::move(value);
+}
+
+/**
+ * Evaluates a list whose meaning is only known at run time from its `count` evaluated elements,
+ * storing the result in the first of them. Procedures made by `lambda` cannot be called here
+ * (see `applyList`).
+ */
+inline void aotApply(Environment& environment, Expression* elements, size_t count) {
+  Expression value;
+  applyList(environment, elements, count, value);
+  elements[0] = std::move(value);
+}
+
+/**
+ * Loads the value of `symbol` into `number`, returning false if it is not bound to a number.
+ */
+inline bool aotLoadNumber(const Environment& environment, SymbolId symbol, double& number) {
+  const Expression* bound = environment.find(symbol);
+  if (bound == nullptr || bound->type != AtomType::Number) {
+    return false;
+  }
+  number = bound->numValue;
+  return true;
+}
+
+inline double aotPower(double a, double b) {
+  return b == 2 ? a * a : std::pow(a, b);
+}
+
+inline void aotDivisionByZero() {
+  throw InterpreterSemanticError("Error: Division by zero");
+}
+
+#endif // AOT_RUNTIME_HPP // Guard against multiple inclusions
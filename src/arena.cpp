@@ -0,0 +1,106 @@
+#include "arena.hpp" // Include header file for Arena class
+#include <cstdint>   // Include cstdint for uintptr_t
+
+/**
+ * This namespace contains helper functions used by the `Arena` class.
+ *
+ *  * `alignUp(char* pointer, size_t alignment)`: Rounds a pointer up to a power-of-two alignment.
+ *  * `blockData(...)`: Returns the first usable byte of a block, right after its header.
+ */
+namespace {
+
+  char* alignUp(char* pointer, size_t alignment) {
+    uintptr_t value = reinterpret_cast<uintptr_t>(pointer);
+    value = (value + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    return reinterpret_cast<char*>(value);
+  }
+
+  template <typename Block>
+  char* blockData(Block* block) {
+    return reinterpret_cast<char*>(block) + sizeof(Block);
+  }
+}
+
+/**
+ * Constructor for the `Arena` class.
+ */
+Arena::Arena(size_t blockSize)
+  : blockSize(blockSize), first(nullptr), current(nullptr), cursor(nullptr), limit(nullptr) {}
+
+/**
+ * Destructor for the `Arena` class. Returns every block to the system.
+ */
+Arena::~Arena() {
+  Block* block = first;
+  while (block != nullptr) {
+    Block* next = block->next;
+    ::operator delete(block);
+    block = next;
+  }
+}
+
+/**
+ * Allocates `bytes` bytes aligned to `alignment` by bumping a pointer in the current block.
+ */
+void* Arena::allocate(size_t bytes, size_t alignment) {
+  char* start = alignUp(cursor, alignment);
+  if (cursor == nullptr || start + bytes > limit) {
+    advance(bytes, alignment);
+    start = alignUp(cursor, alignment);
+  }
+  cursor = start + bytes;
+  return start;
+}
+
+/**
+ * Releases everything allocated so far in O(1) by rewinding to the first block.
+ */
+void Arena::reset() {
+  current = first;
+  if (first != nullptr) {
+    cursor = blockData(first);
+    limit = cursor + first->size;
+  }
+}
+
+/**
+ * Returns the total number of bytes held in blocks owned by the arena.
+ */
+size_t Arena::capacity() const {
+  size_t total = 0;
+  for (Block* block = first; block != nullptr; block = block->next) {
+    total += block->size;
+  }
+  return total;
+}
+
+/**
+ * Moves to the next block that can hold `bytes` bytes, allocating a new one if needed.
+ *
+ * Blocks kept from before a `reset` are reused in order. A block that is too small for the
+ * request is skipped; a new block is linked in right after the current one.
+ */
+void Arena::advance(size_t bytes, size_t alignment) {
+  size_t needed = bytes + alignment;
+  Block* next = current != nullptr ? current->next : first;
+  while (next != nullptr && next->size < needed) {
+    next = next->next;
+  }
+
+  if (next == nullptr) {
+    size_t size = needed > blockSize ? needed : blockSize;
+    next = static_cast<Block*>(::operator new(sizeof(Block) + size));
+    next->size = size;
+    if (current == nullptr) {
+      next->next = first;
+      first = next;
+    } else {
+      next->next = current->next;
+      current->next = next;
+    }
+  }
+
+  current = next;
+  cursor = blockData(next);
+  limit = cursor + next->size;
+}
@@ -0,0 +1,132 @@
+#ifndef ARENA_HPP // Prevent multiple inclusions
+#define ARENA_HPP   // Define a unique identifier for the header file
+
+#include <cstddef>    // Include cstddef for size_t and max_align_t
+#include <new>        // Include new for operator new and operator delete
+#include <type_traits> // Include type_traits for the allocator propagation traits
+
+/**
+ * This header file defines the `Arena` class, a bump allocator that owns every node of one
+ * parsed program, and `ArenaAllocator`, the standard allocator adaptor that draws from it.
+ */
+class Arena {
+public:
+  /**
+   * Default size of one arena block in bytes.
+   */
+  static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+  /**
+   * Constructor for the `Arena` class.
+   *
+   * No memory is reserved until the first allocation. Allocations larger than `blockSize`
+   * get a block of their own.
+   */
+  explicit Arena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+  /**
+   * Destructor for the `Arena` class. Returns every block to the system.
+   */
+  ~Arena();
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /**
+   * Allocates `bytes` bytes aligned to `alignment` by bumping a pointer in the current block.
+   *
+   * Memory is never released individually; it stays owned by the arena until `reset`.
+   */
+  void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+  /**
+   * Releases everything allocated so far in O(1).
+   *
+   * The blocks themselves are kept and reused by later allocations, so an interpreter that
+   * parses one program after another stops calling `malloc` once its arena is warm. Objects
+   * living in the arena must not be used after a reset.
+   */
+  void reset();
+
+  /**
+   * Returns the total number of bytes held in blocks owned by the arena.
+   */
+  size_t capacity() const;
+
+private:
+  struct Block {
+    Block* next;
+    size_t size;
+  };
+
+  /**
+   * Moves to the next block that can hold `bytes` bytes, allocating a new one if needed.
+   */
+  void advance(size_t bytes, size_t alignment);
+
+  size_t blockSize;
+  Block* first;
+  Block* current;
+  char* cursor;
+  char* limit;
+};
+
+/**
+ * Standard allocator that draws memory from an `Arena`.
+ *
+ * A default-constructed allocator (with no arena) falls back to the global heap, so containers
+ * using it behave like ordinary containers unless they are explicitly given an arena. Copying
+ * such a container always produces a heap-backed copy, which keeps values that are copied out
+ * of an arena-backed tree valid after the arena is reset.
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+  typedef T value_type;
+  typedef std::false_type propagate_on_container_copy_assignment;
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+
+  ArenaAllocator() noexcept : arena(nullptr) {}
+
+  explicit ArenaAllocator(Arena* arena) noexcept : arena(arena) {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.source()) {}
+
+  T* allocate(size_t count) {
+    if (arena != nullptr) {
+      return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+    }
+    return static_cast<T*>(::operator new(count * sizeof(T)));
+  }
+
+  void deallocate(T* pointer, size_t) noexcept {
+    if (arena == nullptr) {
+      ::operator delete(pointer);
+    }
+  }
+
+  ArenaAllocator select_on_container_copy_construction() const noexcept {
+    return ArenaAllocator();
+  }
+
+  Arena* source() const noexcept {
+    return arena;
+  }
+
+private:
+  Arena* arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept {
+  return a.source() == b.source();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept {
+  return a.source() != b.source();
+}
+
+#endif // ARENA_HPP // Guard against multiple inclusions
@@ -0,0 +1,178 @@
+#include "builtins.hpp" // Include header file for the builtin table
+#include "interpreter_semantic_error.hpp" // Include header file for InterpreterSemanticError class
+#include <cmath>        // Include cmath for log10 and pow
+
+/**
+ * This namespace contains the builtin procedures.
+ * They are private to this file (`namespace { ... }`) and only reachable through `findBuiltin`.
+ * Their arity is checked by the caller against the table below, so they only check types.
+ */
+namespace {
+
+  /**
+   * Throws unless every argument is a number.
+   */
+  void requireNumbers(const Expression* args, size_t count, const char* name) {
+    for (size_t i = 0; i < count; ++i) {
+      if (args[i].type != AtomType::Number) {
+        throw InterpreterSemanticError(std::string("Error: ") + name + " requires numeric arguments");
+      }
+    }
+  }
+
+  /**
+   * Throws unless every argument is a boolean.
+   */
+  void requireBooleans(const Expression* args, size_t count, const char* name) {
+    for (size_t i = 0; i < count; ++i) {
+      if (args[i].type != AtomType::Boolean) {
+        throw InterpreterSemanticError(std::string("Error: ") + name + " requires boolean arguments");
+      }
+    }
+  }
+
+  void add(Expression* args, size_t count, Expression& value) {
+    requireNumbers(args, count, "Addition");
+    double sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+      sum += args[i].numValue;
+    }
+    value = Expression(sum);
+  }
+
+  void subtract(Expression* args, size_t count, Expression& value) {
+    requireNumbers(args, count, "Subtraction");
+    // With one argument this is negation
+    value = Expression(count == 1 ? -args[0].numValue : args[0].numValue - args[1].numValue);
+  }
+
+  void multiply(Expression* args, size_t count, Expression& value) {
+    requireNumbers(args, count, "Multiplication");
+    double product = 1;
+    for (size_t i = 0; i < count; ++i) {
+      product *= args[i].numValue;
+    }
+    value = Expression(product);
+  }
+
+  void divide(Expression* args, size_t count, Expression& value) {
+    requireNumbers(args, count, "Division");
+    if (args[1].numValue == 0) {
+      throw InterpreterSemanticError("Error: Division by zero");
+    }
+    value = Expression(args[0].numValue / args[1].numValue);
+  }
+
+  /**
+   * Shared implementation of the binary relational procedures.
+   */
+  template <typename Compare>
+  void compare(Expression* args, size_t count, Expression& value, const char* name, Compare test) {
+    requireNumbers(args, count, name);
+    value = Expression(test(args[0].numValue, args[1].numValue));
+  }
+
+  void less(Expression* args, size_t count, Expression& value) {
+    compare(args, count, value, "<", [](double a, double b) { return a < b; });
+  }
+
+  void lessEqual(Expression* args, size_t count, Expression& value) {
+    compare(args, count, value, "<=", [](double a, double b) { return a <= b; });
+  }
+
+  void greater(Expression* args, size_t count, Expression& value) {
+    compare(args, count, value, ">", [](double a, double b) { return a > b; });
+  }
+
+  void greaterEqual(Expression* args, size_t count, Expression& value) {
+    compare(args, count, value, ">=", [](double a, double b) { return a >= b; });
+  }
+
+  void equal(Expression* args, size_t count, Expression& value) {
+    compare(args, count, value, "=", [](double a, double b) { return a == b; });
+  }
+
+  void logicalNot(Expression* args, size_t count, Expression& value) {
+    requireBooleans(args, count, "not");
+    value = Expression(!args[0].boolValue);
+  }
+
+  void logicalAnd(Expression* args, size_t count, Expression& value) {
+    requireBooleans(args, count, "and");
+    bool result = true;
+    for (size_t i = 0; i < count; ++i) {
+      result = result && args[i].boolValue;
+    }
+    value = Expression(result);
+  }
+
+  void logicalOr(Expression* args, size_t count, Expression& value) {
+    requireBooleans(args, count, "or");
+    bool result = false;
+    for (size_t i = 0; i < count; ++i) {
+      result = result || args[i].boolValue;
+    }
+    value = Expression(result);
+  }
+
+  void logarithm(Expression* args, size_t count, Expression& value) {
+    requireNumbers(args, count, "log10");
+    value = Expression(std::log10(args[0].numValue));
+  }
+
+  void power(Expression* args, size_t count, Expression& value) {
+    requireNumbers(args, count, "pow");
+    value = Expression(std::pow(args[0].numValue, args[1].numValue));
+  }
+
+  struct BuiltinEntry {
+    uint32_t symbol;
+    Builtin builtin;
+  };
+
+  /**
+   * The builtin procedures and their arity, indexed by `symbol - FIRST_BUILTIN_PROCEDURE`.
+   */
+  constexpr BuiltinEntry builtinTable[] = {
+    {SYMBOL_ADD, {add, 1, VARIADIC}},
+    {SYMBOL_SUBTRACT, {subtract, 1, 2}},
+    {SYMBOL_MULTIPLY, {multiply, 1, VARIADIC}},
+    {SYMBOL_DIVIDE, {divide, 2, 2}},
+    {SYMBOL_LESS, {less, 2, 2}},
+    {SYMBOL_LESS_EQUAL, {lessEqual, 2, 2}},
+    {SYMBOL_GREATER, {greater, 2, 2}},
+    {SYMBOL_GREATER_EQUAL, {greaterEqual, 2, 2}},
+    {SYMBOL_EQUAL, {equal, 2, 2}},
+    {SYMBOL_NOT, {logicalNot, 1, 1}},
+    {SYMBOL_AND, {logicalAnd, 1, VARIADIC}},
+    {SYMBOL_OR, {logicalOr, 1, VARIADIC}},
+    {SYMBOL_LOG10, {logarithm, 1, 1}},
+    {SYMBOL_POW, {power, 2, 2}},
+  };
+
+  constexpr size_t BUILTIN_COUNT = sizeof(builtinTable) / sizeof(builtinTable[0]);
+
+  /**
+   * Checks at compile time that every entry sits at the index its symbol id maps to.
+   */
+  constexpr bool tableMatchesSymbols() {
+    for (size_t i = 0; i < BUILTIN_COUNT; ++i) {
+      if (builtinTable[i].symbol != FIRST_BUILTIN_PROCEDURE + i) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static_assert(BUILTIN_COUNT == PREDEFINED_SYMBOL_COUNT - FIRST_BUILTIN_PROCEDURE,
+                "every builtin procedure symbol needs a table entry");
+  static_assert(tableMatchesSymbols(), "builtin table entries must follow the PredefinedSymbol order");
+}
+
+/**
+ * Returns the builtin procedure named by `symbol`, or null when the symbol does not name one.
+ */
+const Builtin* findBuiltin(SymbolId symbol) {
+  uint32_t index = symbol.value - FIRST_BUILTIN_PROCEDURE; // Wraps around for smaller ids
+  return index < BUILTIN_COUNT ? &builtinTable[index].builtin : nullptr;
+}
@@ -0,0 +1,47 @@
+#ifndef BUILTINS_HPP // Prevent multiple inclusions
+#define BUILTINS_HPP   // Define a unique identifier for the header file
+
+#include <cstddef>          // Include cstddef for size_t
+#include <cstdint>          // Include cstdint for the arity bounds
+#include "expression.hpp"   // Include header file for Expression class
+#include "symbol_table.hpp" // Include header file for SymbolId
+
+/**
+ * This header file defines the table of builtin procedures (arithmetic, relational, logical
+ * and math) that Slisp programs can call.
+ */
+
+/**
+ * Signature shared by every builtin procedure.
+ *
+ * `args` points to `count` evaluated arguments. They are temporaries owned by the caller, so a
+ * procedure may move from them. The result is stored in `value`. The caller has already
+ * checked `count` against the builtin's arity (see `checkArity`); arguments of the wrong type
+ * are reported by throwing an `InterpreterSemanticError`.
+ */
+typedef void (*BuiltinProcedure)(Expression* args, size_t count, Expression& value);
+
+/**
+ * Upper arity bound of procedures that take any number of arguments.
+ */
+const uint32_t VARIADIC = UINT32_MAX;
+
+/**
+ * A builtin procedure and the number of arguments it accepts.
+ */
+struct Builtin {
+  BuiltinProcedure procedure;
+  uint32_t minArgs;
+  uint32_t maxArgs;
+};
+
+/**
+ * Returns the builtin procedure named by `symbol`, or null when the symbol does not name one.
+ *
+ * Builtin names are interned before any other symbol, in the order of the table, so their ids
+ * form a minimal perfect hash: the lookup is a range check and an array index, and costs the
+ * same for every builtin no matter how many there are.
+ */
+const Builtin* findBuiltin(SymbolId symbol);
+
+#endif // BUILTINS_HPP // Guard against multiple inclusions
@@ -0,0 +1,732 @@
+#include "bytecode.hpp" // Include header file for the bytecode compiler
+#include "optimizer.hpp" // Include header file for resolveAlias
+#include "procedure.hpp" // Include header file for Lambda
+#include <algorithm>    // Include algorithm for std::reverse and std::max
+#include <utility>      // Include utility for std::move
+
+namespace {
+
+  /**
+   * Smallest number of builtin calls a numeric region (see `Compiler`) must contain to be worth
+   * its extra instructions: below this, the inline opcodes on boxed values are as fast.
+   */
+  const uint32_t MIN_REGION_CALLS = 2;
+
+  /**
+   * Returns the opcode computing a builtin on the number stack, or `Opcode::Return` if there is
+   * none. Relational builtins are included: they end a region with a boolean.
+   */
+  Opcode numberOpcode(SymbolId op) {
+    switch (op.value) {
+      case SYMBOL_ADD: return Opcode::AddNumbers;
+      case SYMBOL_SUBTRACT: return Opcode::SubtractNumbers;
+      case SYMBOL_MULTIPLY: return Opcode::MultiplyNumbers;
+      case SYMBOL_DIVIDE: return Opcode::DivideNumbers;
+      case SYMBOL_POW: return Opcode::PowerNumbers;
+      case SYMBOL_LOG10: return Opcode::Log10Number;
+      case SYMBOL_LESS: return Opcode::LessNumbers;
+      case SYMBOL_LESS_EQUAL: return Opcode::LessEqualNumbers;
+      case SYMBOL_GREATER: return Opcode::GreaterNumbers;
+      case SYMBOL_GREATER_EQUAL: return Opcode::GreaterEqualNumbers;
+      case SYMBOL_EQUAL: return Opcode::EqualNumbers;
+      default: return Opcode::Return;
+    }
+  }
+
+  /**
+   * Checks whether `opcode`, returned by `numberOpcode`, leaves a boolean rather than a number.
+   */
+  bool isComparison(Opcode opcode) {
+    return opcode >= Opcode::LessNumbers && opcode <= Opcode::EqualNumbers;
+  }
+
+  /**
+   * Returns the inline opcode for a builtin that has one, or `Opcode::CallBuiltin` otherwise.
+   */
+  Opcode inlineOpcode(SymbolId op) {
+    switch (op.value) {
+      case SYMBOL_ADD: return Opcode::Add;
+      case SYMBOL_SUBTRACT: return Opcode::Subtract;
+      case SYMBOL_MULTIPLY: return Opcode::Multiply;
+      case SYMBOL_DIVIDE: return Opcode::Divide;
+      case SYMBOL_LESS: return Opcode::Less;
+      case SYMBOL_LESS_EQUAL: return Opcode::LessEqual;
+      case SYMBOL_GREATER: return Opcode::Greater;
+      case SYMBOL_GREATER_EQUAL: return Opcode::GreaterEqual;
+      case SYMBOL_EQUAL: return Opcode::Equal;
+      case SYMBOL_POW: return Opcode::Power;
+      default: return Opcode::CallBuiltin;
+    }
+  }
+
+  /**
+   * Emits the instructions for one program. Each node is compiled so that, when run, it
+   * leaves exactly one value on the stack.
+   *
+   * The program is walked with an explicit stack of tasks rather than by recursion, so deeply
+   * nested programs cannot overflow the C++ stack. Compiling a list schedules its children
+   * together with the tasks that emit the instructions between and after them.
+   *
+   * Trees of arithmetic calls whose operands are all numbers, as far as type inference can tell,
+   * are compiled into numeric regions, which compute on the VM's stack of unboxed numbers and
+   * leave a single boxed result. Variables in a region that are not proven to hold numbers are
+   * loaded through a guard; if one holds something else, the region is abandoned and evaluated
+   * again by ordinary code, its fallback, which reports the error exactly as if there had been
+   * no region. The fallbacks are placed after the program's `Return`, out of the way.
+   *
+   * The body of each `lambda` form is compiled the same way, after the code around it, into the
+   * `Lambda` that its closures run.
+   */
+  class Compiler {
+  public:
+    Compiler(const FlatAst& program, const std::vector<NodeInfo>& nodes, const std::vector<LambdaInfo>& lambdas,
+             const std::vector<Expression>& folded, const std::vector<StaticType>& types)
+      : program(program), nodes(nodes), lambdas(lambdas), folded(folded), types(types), code(nullptr) {
+      classifyNumbers();
+    }
+
+    /**
+     * Compiles the program into `main`, and the body of each `lambda` form into its `Lambda`.
+     */
+    void compile(Bytecode& main) {
+      ordinals.assign(program.size(), 0);
+      std::vector<Unit> units{Unit{0, false, &main}};
+      while (!units.empty()) {
+        Unit unit = units.back();
+        units.pop_back();
+        code = unit.code;
+        addLambdas(unit.root, units);
+        tasks.push_back(Task{Action::Compile, unit.root, false, Instruction{}, unit.body});
+        run();
+        emit(Opcode::Return, 0, 0);
+        compileFallbacks();
+      }
+    }
+
+    size_t emit(Opcode opcode, uint32_t count, uint32_t operand) {
+      code->instructions.push_back(Instruction{opcode, count, operand});
+      return code->instructions.size() - 1;
+    }
+
+  private:
+    /**
+     * Code compiled into its own `Bytecode`: the program, rooted at node 0, or the body of a
+     * `lambda` form (`body`), whose value is the value of a call.
+     */
+    struct Unit {
+      uint32_t root;
+      bool body;
+      Bytecode* code;
+    };
+
+    /**
+     * Makes a `Lambda` for every `lambda` form in the code rooted at `root` but not inside
+     * another one, in pre-order, and adds their bodies to `units`.
+     */
+    void addLambdas(uint32_t root, std::vector<Unit>& units) {
+      for (uint32_t node = root; node < program.ends[root]; ++node) {
+        if (nodes[node].kind != NodeKind::Lambda) {
+          continue;
+        }
+        uint32_t parameters = node + 2;
+        std::vector<SymbolId> captures;
+        for (const Capture& capture : lambdas[nodes[node].index].captures) {
+          captures.push_back(capture.symbol);
+        }
+        ordinals[node] = static_cast<uint32_t>(code->lambdas.size());
+        Lambda* lambda = new Lambda(program.expression(node), program.payloads[parameters], std::move(captures));
+        lambda->code.frameSize = program.payloads[parameters];
+        code->lambdas.push_back(lambda);
+        units.push_back(Unit{program.ends[parameters], true, &lambda->code});
+        node = program.ends[node] - 1; // Its body is a unit of its own
+      }
+    }
+
+    /**
+     * Compiles the fallbacks of the numeric regions of the current unit after its `Return`.
+     */
+    void compileFallbacks() {
+      // Fallbacks are compiled as ordinary code throughout, so they never add fallbacks of their own
+      for (Fallback& fallback : fallbacks) {
+        fallback.start = static_cast<uint32_t>(code->instructions.size());
+        if (fallback.region >= 0) {
+          code->regions[fallback.region].fallback = fallback.start;
+        }
+        tasks.push_back(Task{Action::Compile, fallback.node, true, Instruction{}});
+        run();
+        emit(Opcode::Jump, 0, fallback.resume);
+      }
+      for (Instruction& instruction : code->instructions) {
+        if (instruction.opcode == Opcode::LoadNumber) {
+          instruction.count = fallbacks[instruction.count].start;
+        }
+      }
+      fallbacks.clear();
+    }
+
+    void run() {
+      while (!tasks.empty()) {
+        Task task = tasks.back();
+        tasks.pop_back();
+        generic = task.generic;
+        tail = task.tail;
+        switch (task.action) {
+          case Action::Compile:
+            compileNode(task.node);
+            break;
+          case Action::CompileNumber:
+            compileNumber(task.node);
+            break;
+          case Action::EndRegion:
+            // Regions never nest, so the region ending is the last one started
+            if (!fallbacks.empty() && fallbacks.back().node == task.node) {
+              fallbacks.back().resume = static_cast<uint32_t>(code->instructions.size());
+            }
+            if (!code->regions.empty()) {
+              code->regions.back().end = static_cast<uint32_t>(code->instructions.size());
+            }
+            break;
+          case Action::Emit:
+            code->instructions.push_back(task.instruction);
+            break;
+          case Action::Discard:
+            if (nodes[resolveAlias(nodes, task.node)].kind == NodeKind::Define) {
+              code->instructions.back().count = 1; // Move the value into the environment instead
+            } else {
+              emit(Opcode::Pop, 0, 0);
+            }
+            break;
+          case Action::SkipConsequent:
+            jumps.push_back(emit(Opcode::JumpIfFalse, 0, 0));
+            break;
+          case Action::SkipAlternative: {
+            size_t skipAlternative = emit(Opcode::Jump, 0, 0);
+            patch(jumps.back());
+            jumps.back() = skipAlternative;
+            break;
+          }
+          case Action::EndIf:
+            patch(jumps.back());
+            jumps.pop_back();
+            break;
+          case Action::ShortCircuit:
+            jumps.push_back(code->instructions.size());
+            code->instructions.push_back(task.instruction);
+            break;
+          case Action::EndShortCircuit:
+            // Every operand may end the form early
+            for (uint32_t operand = 1; operand < program.payloads[task.node]; ++operand) {
+              patch(jumps.back());
+              jumps.pop_back();
+            }
+            break;
+        }
+      }
+    }
+
+    /**
+     * Steps of the walk:
+     *  - Compile: compile `node`. When `generic` is set, the node and
+     *    everything below it is compiled without numeric regions. When `tail` is set, the value
+     *    of `node` is the value of the procedure body being compiled.
+     *  - CompileNumber: compile `node`, part of a numeric region, to leave its value on the
+     *    number stack.
+     *  - EndRegion: note where the numeric region rooted at `node` ends.
+     *  - Emit: emit `instruction`, once the operands before it have been compiled.
+     *  - Discard: drop the value of `node`, an operand of `begin` other than the last.
+     *  - SkipConsequent / SkipAlternative / EndIf: emit and patch the jumps of an `if`, after
+     *    its condition, consequent and alternative respectively.
+     *  - ShortCircuit / EndShortCircuit: emit `instruction`, the test after an operand of `and`
+     *    or `or`, and patch the tests of `node` once all of its operands have been compiled.
+     */
+    enum class Action : uint8_t {
+      Compile, CompileNumber, EndRegion, Emit, Discard, SkipConsequent, SkipAlternative, EndIf, ShortCircuit,
+      EndShortCircuit
+    };
+
+    struct Task {
+      Action action;
+      uint32_t node;
+      bool generic;
+      Instruction instruction;
+      bool tail = false;
+    };
+
+    /**
+     * What a node contributes to a numeric region:
+     *  - NUMBER: its value can be computed on the number stack.
+     *  - GUARDED: it loads a variable that is not proven to hold a number.
+     *  - OPAQUE: it contains an operand that is compiled as ordinary code and then unboxed,
+     *    because type inference proved it is a number though it is no arithmetic call.
+     *
+     * A region never has both guards and opaque operands: evaluating it again after a failed
+     * guard would repeat whatever the opaque operands did.
+     */
+    enum NumberFlags : uint8_t { NUMBER = 1, GUARDED = 2, OPAQUE = 4 };
+
+    struct NumberInfo {
+      uint8_t flags;
+      uint32_t calls; // Builtin calls in the subtree that run on the number stack
+    };
+
+    /**
+     * The ordinary code evaluating the region rooted at `node` when one of its guards fails. It
+     * starts at instruction `start` and continues at `resume`, the end of the region. `region`
+     * is the index of the region in `Bytecode::regions`, or -1 if it has no entry there.
+     */
+    struct Fallback {
+      uint32_t node;
+      uint32_t resume;
+      uint32_t start;
+      int32_t region;
+    };
+
+    /**
+     * Fills `numbers` for every node, from the leaves up.
+     */
+    void classifyNumbers() {
+      numbers.assign(program.size(), NumberInfo{0, 0});
+      for (uint32_t node = program.size(); node-- > 0;) {
+        NumberInfo& info = numbers[node];
+        uint32_t target = resolveAlias(nodes, node);
+        if (target != node) {
+          info = numbers[target];
+          continue;
+        }
+        switch (nodes[node].kind) {
+          case NodeKind::Literal:
+          case NodeKind::Constant:
+            info.flags = types[node] == StaticType::Number ? NUMBER : 0;
+            continue;
+          case NodeKind::Variable:
+            if (types[node] != StaticType::Boolean) {
+              info.flags = types[node] == StaticType::Number ? NUMBER : NUMBER | GUARDED;
+            }
+            continue;
+          case NodeKind::BuiltinCall:
+            if (regionOperands(node, info) && !isComparison(numberOpcode(program.symbol(node + 1)))) {
+              info.flags |= NUMBER;
+              continue;
+            }
+            break;
+          default:
+            break;
+        }
+        info = NumberInfo{static_cast<uint8_t>(types[node] == StaticType::Number ? NUMBER | OPAQUE : 0), 0};
+      }
+    }
+
+    /**
+     * Checks whether the builtin call `node` can run on the number stack, accumulating what its
+     * operands contribute into `info`.
+     */
+    bool regionOperands(uint32_t node, NumberInfo& info) const {
+      if (numberOpcode(program.symbol(node + 1)) == Opcode::Return) {
+        return false;
+      }
+      NumberInfo operands{0, 1};
+      for (uint32_t child = program.ends[node + 1]; child < program.ends[node]; child = program.ends[child]) {
+        const NumberInfo& operand = numbers[child];
+        if ((operand.flags & NUMBER) == 0) {
+          return false;
+        }
+        operands.flags |= operand.flags;
+        operands.calls += operand.calls;
+      }
+      if ((operands.flags & GUARDED) != 0 && (operands.flags & OPAQUE) != 0) {
+        return false;
+      }
+      info = NumberInfo{static_cast<uint8_t>(operands.flags & (GUARDED | OPAQUE)), operands.calls};
+      return true;
+    }
+
+    /**
+     * Compiles the builtin call `node` as a numeric region if it is worth one, returning false
+     * if it is to be compiled as ordinary code.
+     */
+    bool compileRegion(uint32_t node) {
+      NumberInfo info{0, 0};
+      if (generic || !regionOperands(node, info) || info.calls < MIN_REGION_CALLS) {
+        return false;
+      }
+      int32_t region = -1;
+#ifdef SLISP_JIT
+      // Marks the region so the VM can count its runs and switch to machine code
+      region = static_cast<int32_t>(code->regions.size());
+      emit(Opcode::EnterRegion, 0, static_cast<uint32_t>(region));
+      code->regions.push_back(NumericRegion{static_cast<uint32_t>(code->instructions.size()), 0, 0, 0, -1});
+#endif
+      if ((info.flags & GUARDED) != 0) {
+        fallbacks.push_back(Fallback{node, 0, 0, region});
+      }
+      Opcode opcode = numberOpcode(program.symbol(node + 1));
+      if (isComparison(opcode)) {
+        scheduleNumberOperands(node);
+        schedule(Instruction{opcode, 2, 0});
+      } else {
+        tasks.push_back(Task{Action::CompileNumber, node, false, Instruction{}});
+        schedule(Instruction{Opcode::Box, 0, 0});
+      }
+      tasks.push_back(Task{Action::EndRegion, node, false, Instruction{}});
+      return true;
+    }
+
+    /**
+     * Compiles `node`, part of a numeric region, to leave its value on the number stack.
+     */
+    void compileNumber(uint32_t node) {
+      node = resolveAlias(nodes, node);
+      if ((numbers[node].flags & OPAQUE) != 0 && numbers[node].calls == 0) {
+        // Proven to be a number, but only ordinary code can evaluate it
+        tasks.push_back(Task{Action::Emit, 0, true, Instruction{Opcode::Unbox, 0, 0}});
+        tasks.push_back(Task{Action::Compile, node, true, Instruction{}});
+        return;
+      }
+      switch (nodes[node].kind) {
+        case NodeKind::Literal:
+        case NodeKind::Constant:
+          code->numbers.push_back(constantNumber(node));
+          emit(Opcode::PushNumber, 0, static_cast<uint32_t>(code->numbers.size() - 1));
+          return;
+        case NodeKind::Variable:
+          if (types[node] == StaticType::Number) {
+            emit(Opcode::LoadProvenNumber, 0, program.symbol(node).value);
+          } else {
+            // `count` holds the fallback's index until the fallbacks have been placed
+            emit(Opcode::LoadNumber, static_cast<uint32_t>(fallbacks.size() - 1), program.symbol(node).value);
+          }
+          return;
+        default:
+          break;
+      }
+
+      size_t mark = tasks.size();
+      uint32_t count = scheduleNumberOperands(node);
+      schedule(Instruction{numberOpcode(program.symbol(node + 1)), count, 0});
+      std::reverse(tasks.begin() + mark, tasks.end());
+    }
+
+    /**
+     * Schedules compiling the operands of the builtin call `node` onto the number stack,
+     * returning how many there are.
+     */
+    uint32_t scheduleNumberOperands(uint32_t node) {
+      uint32_t count = 0;
+      for (uint32_t child = program.ends[node + 1]; child < program.ends[node]; child = program.ends[child]) {
+        tasks.push_back(Task{Action::CompileNumber, child, false, Instruction{}});
+        ++count;
+      }
+      return count;
+    }
+
+    /**
+     * Returns the number a constant node for which `numbers` holds `NUMBER` evaluates to.
+     */
+    double constantNumber(uint32_t node) const {
+      if (nodes[node].kind == NodeKind::Constant) {
+        return folded[nodes[node].index].numValue;
+      }
+      return program.numbers[program.payloads[node]];
+    }
+
+    void compileNode(uint32_t node) {
+      node = resolveAlias(nodes, node);
+      uint32_t first = node + 1;
+
+      // Tasks are scheduled in the order they run and reversed at the end, since the last
+      // task pushed runs first
+      size_t mark = tasks.size();
+      switch (nodes[node].kind) {
+        case NodeKind::Literal:
+        case NodeKind::Constant:
+          emit(Opcode::PushConstant, 0, addConstant(node));
+          break;
+        case NodeKind::Variable:
+          emit(Opcode::LoadVariable, 0, program.symbol(node).value);
+          break;
+        case NodeKind::Local:
+          emit(Opcode::LoadLocal, 0, nodes[node].index);
+          break;
+        case NodeKind::Captured:
+          emit(Opcode::LoadCaptured, 0, nodes[node].index);
+          break;
+        case NodeKind::Lambda: {
+          // The body has a unit of its own; the closure only needs the captured values
+          const std::vector<Capture>& captures = lambdas[nodes[node].index].captures;
+          for (const Capture& capture : captures) {
+            emit(capture.kind == NodeKind::Local ? Opcode::LoadLocal : Opcode::LoadCaptured, 0, capture.index);
+          }
+          emit(Opcode::MakeClosure, static_cast<uint32_t>(captures.size()), ordinals[node]);
+          break;
+        }
+        case NodeKind::Let: {
+          // Each value is stored in its slot as soon as it has been evaluated: the values never
+          // see the variables, and the forms in them only use slots after these
+          uint32_t bindings = program.ends[first];
+          uint32_t slot = nodes[node].index;
+          for (uint32_t binding = bindings + 1; binding < program.ends[bindings]; binding = program.ends[binding]) {
+            schedule(program.ends[binding + 1]);
+            schedule(Instruction{Opcode::StoreLocal, 0, slot++});
+          }
+          code->frameSize = std::max(code->frameSize, slot);
+          if (tail) {
+            scheduleTail(program.ends[bindings]);
+          } else {
+            // The tree walker keeps the form open to unbind its variables afterwards
+            schedule(program.ends[bindings]);
+          }
+          break;
+        }
+        case NodeKind::Define: {
+          uint32_t name = program.ends[first];
+          schedule(program.ends[name]);
+          schedule(Instruction{Opcode::Define, 0, program.symbol(name).value});
+          break;
+        }
+        case NodeKind::Begin:
+          // Every operand but the last is only evaluated for its effect
+          for (uint32_t child = program.ends[first]; child < program.ends[node]; child = program.ends[child]) {
+            if (program.ends[child] == program.ends[node]) {
+              scheduleTail(child);
+              break;
+            }
+            if (isConstant(child)) {
+              continue; // No effect
+            }
+            schedule(child);
+            tasks.push_back(Task{Action::Discard, child, generic, Instruction{}});
+          }
+          break;
+        case NodeKind::If: {
+          // Only the selected branch is evaluated
+          uint32_t condition = program.ends[first];
+          uint32_t consequent = program.ends[condition];
+          uint32_t alternative = program.ends[consequent];
+          schedule(condition);
+          tasks.push_back(Task{Action::SkipConsequent, node, generic, Instruction{}});
+          scheduleTail(consequent);
+          tasks.push_back(Task{Action::SkipAlternative, node, generic, Instruction{}});
+          scheduleTail(alternative);
+          tasks.push_back(Task{Action::EndIf, node, generic, Instruction{}});
+          break;
+        }
+        case NodeKind::And:
+        case NodeKind::Or: {
+          // Each operand is tested as soon as it has been evaluated
+          Opcode opcode = nodes[node].kind == NodeKind::And ? Opcode::And : Opcode::Or;
+          for (uint32_t child = program.ends[first]; child < program.ends[node]; child = program.ends[child]) {
+            uint32_t last = program.ends[child] == program.ends[node] ? 1 : 0;
+            schedule(child);
+            tasks.push_back(Task{Action::ShortCircuit, child, generic, Instruction{opcode, last, 0}});
+          }
+          tasks.push_back(Task{Action::EndShortCircuit, node, generic, Instruction{}});
+          break;
+        }
+        case NodeKind::BuiltinCall: {
+          if (compileRegion(node)) {
+            break;
+          }
+          Opcode opcode = inlineOpcode(program.symbol(first));
+          uint32_t left = program.ends[first];
+          if (opcode != Opcode::CallBuiltin && program.payloads[node] == 3) {
+            // Two operands: computed inline, with a literal right operand read from the constants
+            uint32_t right = program.ends[left];
+            schedule(left);
+            if (isConstant(right)) {
+              schedule(Instruction{opcode, 1, addConstant(right)});
+            } else {
+              schedule(right);
+              schedule(Instruction{opcode, 2, 0});
+            }
+            break;
+          }
+          code->procedures.push_back(nodes[node].procedure);
+          schedule(Instruction{Opcode::CallBuiltin, scheduleChildren(left, node),
+                               static_cast<uint32_t>(code->procedures.size() - 1)});
+          break;
+        }
+        case NodeKind::Apply:
+          schedule(Instruction{tail ? Opcode::TailApply : Opcode::Apply, scheduleChildren(first, node), 0});
+          break;
+        case NodeKind::Parameters:
+          break; // Never evaluated
+        case NodeKind::Alias:
+          break; // Resolved above
+      }
+      std::reverse(tasks.begin() + mark, tasks.end());
+    }
+
+    /**
+     * Schedules compiling `node`, a child of the node being compiled.
+     */
+    void schedule(uint32_t node) {
+      tasks.push_back(Task{Action::Compile, node, generic, Instruction{}});
+    }
+
+    /**
+     * Schedules compiling `node`, whose value is the value of the node being compiled: a branch
+     * of `if`, the last operand of `begin`, or the body of a `let` in tail position of a
+     * procedure body. It stays in tail position of a procedure body if its parent is.
+     */
+    void scheduleTail(uint32_t node) {
+      tasks.push_back(Task{Action::Compile, node, generic, Instruction{}, tail});
+    }
+
+    /**
+     * Schedules emitting `instruction`.
+     */
+    void schedule(const Instruction& instruction) {
+      tasks.push_back(Task{Action::Emit, 0, generic, instruction});
+    }
+
+    /**
+     * Schedules compiling the children of `node` from `child` on, returning how many there were.
+     */
+    uint32_t scheduleChildren(uint32_t child, uint32_t node) {
+      uint32_t count = 0;
+      for (; child < program.ends[node]; child = program.ends[child]) {
+        schedule(child);
+        ++count;
+      }
+      return count;
+    }
+
+    /**
+     * Checks whether `node` is a literal or was folded into a constant.
+     */
+    bool isConstant(uint32_t node) const {
+      NodeKind kind = nodes[resolveAlias(nodes, node)].kind;
+      return kind == NodeKind::Literal || kind == NodeKind::Constant;
+    }
+
+    /**
+     * Adds the value of a node for which `isConstant` holds to the constants, returning its index.
+     */
+    uint32_t addConstant(uint32_t node) {
+      node = resolveAlias(nodes, node);
+      if (nodes[node].kind == NodeKind::Constant) {
+        code->constants.push_back(folded[nodes[node].index]);
+      } else if (program.types[node] == AtomType::Number) {
+        code->constants.emplace_back(program.numbers[program.payloads[node]]);
+      } else {
+        code->constants.emplace_back(program.booleans[program.payloads[node]] != 0);
+      }
+      return static_cast<uint32_t>(code->constants.size() - 1);
+    }
+
+    /**
+     * Points the jump at `index` to the next instruction to be emitted.
+     */
+    void patch(size_t index) {
+      code->instructions[index].operand = static_cast<uint32_t>(code->instructions.size());
+    }
+
+    const FlatAst& program;
+    const std::vector<NodeInfo>& nodes;
+    const std::vector<LambdaInfo>& lambdas;
+    const std::vector<Expression>& folded;
+    const std::vector<StaticType>& types;
+    Bytecode* code; // The unit being compiled
+    std::vector<Task> tasks;
+    std::vector<size_t> jumps; // Unpatched jumps of the `if` forms being compiled, innermost last
+    std::vector<NumberInfo> numbers;
+    std::vector<Fallback> fallbacks;
+    std::vector<uint32_t> ordinals; // For each `lambda` form, its index in the `lambdas` of its unit
+    bool generic = false; // Whether the task being run compiles ordinary code only
+    bool tail = false;    // Whether the task being run compiles the value of a procedure body
+  };
+}
+
+/**
+ * Returns the name of an opcode, for diagnostics.
+ */
+const char* opcodeName(Opcode opcode) {
+  switch (opcode) {
+    case Opcode::PushConstant: return "push-constant";
+    case Opcode::LoadVariable: return "load-variable";
+    case Opcode::LoadLocal: return "load-local";
+    case Opcode::StoreLocal: return "store-local";
+    case Opcode::LoadCaptured: return "load-captured";
+    case Opcode::Define: return "define";
+    case Opcode::Pop: return "pop";
+    case Opcode::Jump: return "jump";
+    case Opcode::JumpIfFalse: return "jump-if-false";
+    case Opcode::CallBuiltin: return "call-builtin";
+    case Opcode::Apply: return "apply";
+    case Opcode::TailApply: return "tail-apply";
+    case Opcode::MakeClosure: return "make-closure";
+    case Opcode::Add: return "add";
+    case Opcode::Subtract: return "subtract";
+    case Opcode::Multiply: return "multiply";
+    case Opcode::Divide: return "divide";
+    case Opcode::Less: return "less";
+    case Opcode::LessEqual: return "less-equal";
+    case Opcode::Greater: return "greater";
+    case Opcode::GreaterEqual: return "greater-equal";
+    case Opcode::Equal: return "equal";
+    case Opcode::Power: return "power";
+    case Opcode::And: return "and";
+    case Opcode::Or: return "or";
+    case Opcode::PushNumber: return "push-number";
+    case Opcode::LoadNumber: return "load-number";
+    case Opcode::LoadProvenNumber: return "load-proven-number";
+    case Opcode::Unbox: return "unbox";
+    case Opcode::AddNumbers: return "add-numbers";
+    case Opcode::SubtractNumbers: return "subtract-numbers";
+    case Opcode::MultiplyNumbers: return "multiply-numbers";
+    case Opcode::DivideNumbers: return "divide-numbers";
+    case Opcode::PowerNumbers: return "power-numbers";
+    case Opcode::Log10Number: return "log10-number";
+    case Opcode::LessNumbers: return "less-numbers";
+    case Opcode::LessEqualNumbers: return "less-equal-numbers";
+    case Opcode::GreaterNumbers: return "greater-numbers";
+    case Opcode::GreaterEqualNumbers: return "greater-equal-numbers";
+    case Opcode::EqualNumbers: return "equal-numbers";
+    case Opcode::Box: return "box";
+    case Opcode::EnterRegion: return "enter-region";
+    case Opcode::Return: return "return";
+  }
+  return "unknown";
+}
+
+/**
+ * Destructor. Releases the lambdas.
+ */
+Bytecode::~Bytecode() {
+  for (Lambda* lambda : lambdas) {
+    releaseLambda(lambda);
+  }
+}
+
+/**
+ * Removes every instruction and table entry, keeping their capacity.
+ */
+void Bytecode::clear() {
+  for (Lambda* lambda : lambdas) {
+    releaseLambda(lambda);
+  }
+  lambdas.clear();
+  frameSize = 0;
+  instructions.clear();
+  constants.clear();
+  numbers.clear();
+  procedures.clear();
+  regions.clear();
+#ifdef SLISP_JIT
+  native.clear();
+#endif
+}
+
+/**
+ * Compiles `program` into `code`, replacing its contents.
+ */
+void compileProgram(const FlatAst& program, const std::vector<NodeInfo>& nodes,
+                    const std::vector<LambdaInfo>& lambdas, const std::vector<Expression>& folded,
+                    const std::vector<StaticType>& types, Bytecode& code) {
+  code.clear();
+  if (program.size() == 0) {
+    return;
+  }
+  Compiler compiler(program, nodes, lambdas, folded, types);
+  compiler.compile(code);
+}
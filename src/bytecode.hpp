@@ -0,0 +1,211 @@
+#ifndef BYTECODE_HPP // Prevent multiple inclusions
+#define BYTECODE_HPP   // Define a unique identifier for the header file
+
+#include <cstddef>          // Include cstddef for size_t
+#include <cstdint>          // Include cstdint for instruction operands
+#include <vector>           // Include vector for the instruction stream
+#include "analysis.hpp"     // Include header file for NodeInfo
+#include "builtins.hpp"     // Include header file for BuiltinProcedure
+#include "expression.hpp"   // Include header file for Expression class
+#include "flat_ast.hpp"     // Include header file for FlatAst class
+#include "jit.hpp"          // Include header file for NativeCode class
+#include "type_inference.hpp" // Include header file for StaticType
+
+/**
+ * This header file defines the bytecode that the virtual machine (see `vm.hpp`) executes and
+ * the compiler that produces it from an analyzed program.
+ */
+
+/**
+ * Operations of the stack machine. Each instruction pops its inputs from the value stack and
+ * pushes its result.
+ *
+ *  - PushConstant: push `constants[operand]`.
+ *  - LoadVariable: push the value of the symbol with id `operand`, or the symbol itself when it
+ *    is not defined (it may name a procedure).
+ *  - LoadLocal: push the variable in slot `operand` of the frame being run (see
+ *    `Bytecode::frameSize`).
+ *  - StoreLocal: pop the value on top of the stack into slot `operand` of the frame being run,
+ *    binding a variable of `let`.
+ *  - LoadCaptured: push the value in slot `operand` of the closure being run.
+ *  - Define: bind the symbol with id `operand` to the value on top of the stack. The value is
+ *    left there, unless `count` is 1, in which case it is moved into the environment instead
+ *    (a define whose value is discarded, as inside `begin`).
+ *  - Pop: discard the value on top of the stack.
+ *  - Jump: continue at instruction `operand`.
+ *  - JumpIfFalse: pop a boolean and continue at instruction `operand` if it is false.
+ *  - CallBuiltin: call `procedures[operand]` with the top `count` values as arguments.
+ *  - Apply: evaluate a list whose meaning is only known at run time, from the top `count`
+ *    values (its evaluated elements). If the first is a procedure, it is called with the others
+ *    as arguments, running `lambdas[...].code` of its closure in a new call frame.
+ *  - TailApply: Apply in tail position of a procedure body, whose value is the value of the
+ *    call. A procedure called here reuses the frame of the call being run, so tail calls
+ *    run in constant space however many there are.
+ *  - MakeClosure: push a procedure made from `lambdas[operand]`, capturing the top `count`
+ *    values.
+ *  - Add, Subtract, Multiply, Divide, Less, LessEqual, Greater, GreaterEqual, Equal, Power: the
+ *    builtin of the same name applied to two numbers, computed inline (Power squares by a
+ *    single multiplication). When `count` is 2 both operands are on the stack; when it is 1
+ *    only the left one is, and the right one is `constants[operand]`. Anything other than two
+ *    numbers (or a division by zero) falls back to the builtin procedure, which reports the
+ *    error.
+ *  - And, Or: check that the value on top of the stack is a boolean. If it decides the result
+ *    (false for And, true for Or), continue at instruction `operand` with it as the result.
+ *    Otherwise pop it and continue with the next operand, unless `count` is 1: the last operand
+ *    is the result whatever its value.
+ *  - Return: finish, with the value on top of the stack as the result.
+ *
+ * Numeric regions (see `compileProgram`) compute on a second stack of unboxed numbers:
+ *  - PushNumber: push `numbers[operand]`.
+ *  - LoadNumber: push the value of the symbol with id `operand`. If it is not bound to a
+ *    number, clear the number stack and continue at instruction `count`, the region's fallback.
+ *  - LoadProvenNumber: push the value of the symbol with id `operand`, which type inference
+ *    proved is bound to a number.
+ *  - Unbox: pop a value proven to be a number from the value stack and push it.
+ *  - AddNumbers, SubtractNumbers, MultiplyNumbers: the builtin of the same name applied to the
+ *    top `count` numbers.
+ *  - DivideNumbers, PowerNumbers, Log10Number: the builtin of the same name applied to the top
+ *    two numbers (one for Log10Number).
+ *  - LessNumbers, LessEqualNumbers, GreaterNumbers, GreaterEqualNumbers, EqualNumbers: the
+ *    builtin of the same name applied to the top two numbers, pushing the boolean result onto
+ *    the value stack.
+ *  - Box: pop a number and push it onto the value stack.
+ *  - EnterRegion: start the numeric region `regions[operand]`. Emitted in JIT builds only,
+ *    where it runs the region's machine code instead once the region is hot (see `jit.hpp`).
+ *
+ * The inline operations and the `count` forms of Define are superinstructions: they replace
+ * the most frequent opcode sequences reported by an `SLISP_COUNT_OPCODES` build
+ * (push-constant followed by call-builtin, and define followed by pop).
+ */
+enum class Opcode : uint8_t {
+  PushConstant,
+  LoadVariable,
+  LoadLocal,
+  StoreLocal,
+  LoadCaptured,
+  Define,
+  Pop,
+  Jump,
+  JumpIfFalse,
+  CallBuiltin,
+  Apply,
+  TailApply,
+  MakeClosure,
+  Add,
+  Subtract,
+  Multiply,
+  Divide,
+  Less,
+  LessEqual,
+  Greater,
+  GreaterEqual,
+  Equal,
+  Power,
+  And,
+  Or,
+  PushNumber,
+  LoadNumber,
+  LoadProvenNumber,
+  Unbox,
+  AddNumbers,
+  SubtractNumbers,
+  MultiplyNumbers,
+  DivideNumbers,
+  PowerNumbers,
+  Log10Number,
+  LessNumbers,
+  LessEqualNumbers,
+  GreaterNumbers,
+  GreaterEqualNumbers,
+  EqualNumbers,
+  Box,
+  EnterRegion,
+  Return // Must stay last, see OPCODE_COUNT
+};
+
+/**
+ * Number of opcodes.
+ */
+const size_t OPCODE_COUNT = static_cast<size_t>(Opcode::Return) + 1;
+
+/**
+ * Returns the name of an opcode, for diagnostics.
+ */
+const char* opcodeName(Opcode opcode);
+
+/**
+ * A single instruction: an opcode, an argument count and an operand whose meaning depends on
+ * the opcode.
+ */
+struct Instruction {
+  Opcode opcode;
+  uint32_t count;
+  uint32_t operand;
+};
+
+/**
+ * A numeric region entered by an `EnterRegion` instruction.
+ */
+struct NumericRegion {
+  uint32_t start;    // First instruction of the region
+  uint32_t end;      // Instruction after the region
+  uint32_t fallback; // First instruction of its fallback, if it loads variables through guards
+  uint32_t runs;     // Number of times it was entered, up to JIT_THRESHOLD
+  int32_t native;    // Index of its machine code in `Bytecode::native`, or -1
+};
+
+struct Lambda;
+
+/**
+ * A compiled program, or the body of a `lambda` form: the instruction stream and the tables its
+ * operands refer to. `lambdas` holds a reference to each `lambda` form directly inside it.
+ *
+ * `frameSize` is the number of slots of the frame it runs in, at the bottom of its part of the
+ * value stack: the arguments of a procedure call, then the variables of the `let` forms inside.
+ */
+struct Bytecode {
+  std::vector<Instruction> instructions;
+  std::vector<Expression> constants;
+  std::vector<double> numbers;
+  std::vector<BuiltinProcedure> procedures;
+  std::vector<NumericRegion> regions;
+  std::vector<Lambda*> lambdas;
+  uint32_t frameSize = 0;
+#ifdef SLISP_JIT
+  NativeCode native;
+#endif
+
+  Bytecode() = default;
+  Bytecode(const Bytecode&) = delete;
+  Bytecode& operator=(const Bytecode&) = delete;
+
+  /**
+   * Destructor. Releases the lambdas (see `releaseLambda`).
+   */
+  ~Bytecode();
+
+  /**
+   * Removes every instruction and table entry, keeping their capacity. Closures made by the
+   * program keep the lambdas they need.
+   */
+  void clear();
+};
+
+/**
+ * Compiles `program` into `code`, replacing its contents.
+ *
+ * `nodes` and `lambdas` must be the result of `analyzeProgram` for the same program, so every
+ * special form, builtin call and variable has already been resolved and checked, optionally
+ * rewritten by `optimizeProgram`, in which case `folded` holds its constants. `types` must be
+ * the result of `inferTypes`: nested arithmetic whose operands are numbers is compiled into
+ * numeric regions, which keep intermediate results unboxed, and variables inference could not
+ * prove to be numbers are guarded there with a fallback to ordinary code.
+ *
+ * The body of every `lambda` form is compiled too, into a `Lambda` of its own, so evaluating
+ * the form only has to capture values.
+ */
+void compileProgram(const FlatAst& program, const std::vector<NodeInfo>& nodes,
+                    const std::vector<LambdaInfo>& lambdas, const std::vector<Expression>& folded,
+                    const std::vector<StaticType>& types, Bytecode& code);
+
+#endif // BYTECODE_HPP // Guard against multiple inclusions
@@ -1,14 +1,14 @@
 #include "environment.hpp"
+#include <cmath>   // Include cmath for atan2
+#include <utility> // Include utility for std::move
 
 /**
  * Default constructor for the Environment class.
  *
- * This constructor initializes the environment with an empty symbol table.
- * You can potentially add further initialization logic here if needed for
-    your specific use case.
+ * This constructor initializes the environment with the builtin constants.
  */
 Environment::Environment() {
-  // This part will initialize the environment if needed
+  resetEnvironment();
 }
 
 /**
@@ -22,26 +22,63 @@ Environment::Environment() {
  */
 void Environment::addSymbol(const std::string& symbol, const Expression& exp) {
   // Here we add the symbol to the environment
-  symbolTable[symbol] = exp;
+  addSymbol(internSymbol(symbol), exp);
+}
+
+/**
+ * Adds a symbol, given by its interned id, and its expression to the environment.
+ */
+void Environment::addSymbol(SymbolId symbol, const Expression& exp) {
+  addSymbol(symbol, Expression(exp));
+}
+
+/**
+ * Adds a symbol and its expression to the environment, moving the expression into the
+ * symbol table instead of copying it.
+ *
+ * The table grows to cover the id on demand.
+ */
+void Environment::addSymbol(SymbolId symbol, Expression&& exp) {
+  if (symbol.value >= symbolTable.size()) {
+    symbolTable.resize(symbol.value + 1);
+    bound.resize(symbol.value + 1, 0);
+  }
+  symbolTable[symbol.value] = std::move(exp);
+  bound[symbol.value] = 1;
 }
 
 /**
  * Retrieves the expression associated with a given symbol from the environment.
  *
  * This function takes a string representing the symbol name as input.
- * It searches the symbol table for the corresponding entry and returns the associated expression.
+ * It searches the symbol table for the corresponding entry and returns a reference to the
+ * associated expression, so looking up a symbol never copies its value.
  *
- * If the symbol is not found in the environment, the function returns a default `Expression` object
-  (which can be improved upon for handling missing symbols).
+ * If the symbol is not found in the environment, the function throws an `InterpreterSemanticError`.
  */
-Expression Environment::getExpression(const std::string& symbol) const {
+const Expression& Environment::getExpression(const std::string& symbol) const {
+  return getExpression(internSymbol(symbol));
+}
+
+/**
+ * Retrieves the expression associated with a symbol given by its interned id.
+ */
+const Expression& Environment::getExpression(SymbolId symbol) const {
   // Get expression associated with the symbol
-  auto it = symbolTable.find(symbol);
-  if (it != symbolTable.end()) {
-    return it->second;
-  } else {
-    return Expression(); // Return a default expression if symbol not found (can be improved)
+  const Expression* exp = find(symbol);
+  if (exp == nullptr) {
+    throw InterpreterSemanticError("Error: unknown symbol " + symbolName(symbol));
   }
+  return *exp;
+}
+
+/**
+ * Internal helper function to find an expression in the environment.
+ *
+ * Returns a pointer to the expression bound to `key`, or a null pointer if there is none.
+ */
+const Expression* Environment::find(SymbolId key) const {
+  return key.value < bound.size() && bound[key.value] ? &symbolTable[key.value] : nullptr;
 }
 
 /**
@@ -52,16 +89,25 @@ Expression Environment::getExpression(const std::string& symbol) const {
  */
 bool Environment::symbolExists(const std::string& symbol) const {
   // Check if symbol exists in the environment
-  return symbolTable.find(symbol) != symbolTable.end();
+  return symbolExists(internSymbol(symbol));
+}
+
+/**
+ * Checks if a symbol given by its interned id exists in the environment's symbol table.
+ */
+bool Environment::symbolExists(SymbolId symbol) const {
+  return find(symbol) != nullptr;
 }
 
 /**
  * Resets the environment to its initial state.
  *
  * This function clears the internal symbol table, effectively removing all previously added
- symbols and their associated expressions from the environment.
+ symbols and their associated expressions from the environment. The builtin constants are kept.
  */
 void Environment::resetEnvironment() {
-  // Reset the environment to the default state
+  // Reset the environment to the default state, which only holds the builtin constants
   symbolTable.clear();
+  bound.clear();
+  addSymbol(SymbolId{SYMBOL_PI}, Expression(std::atan2(0, -1)));
 }
@@ -1,8 +1,10 @@
 #ifndef ENVIRONMENT_HPP // Prevent multiple inclusions
 #define ENVIRONMENT_HPP   // Define a unique identifier for the header file
 
-#include <unordered_map>  // Include necessary header for unordered_map
+#include <cstdint>        // Include cstdint for the binding flags
+#include <vector>         // Include vector for the symbol table
 #include "expression.hpp"  // Include header file for Expression class
+#include "symbol_table.hpp" // Include header file for SymbolId
 #include "interpreter_semantic_error.hpp" // Include header file for InterpreterSemanticError class
 
 /**
@@ -14,7 +16,7 @@ public:
   /**
    * Default constructor for the `Environment` class.
    *
-   * This constructor initializes an empty symbol table for storing variables.
+   * This constructor initializes the symbol table with the builtin constants, such as `pi`.
    */
   Environment();
 
@@ -29,16 +31,33 @@ public:
    */
   void addSymbol(const std::string& symbol, const Expression& exp);
 
+  /**
+   * Adds a symbol, given by its interned id, and its expression to the environment.
+   */
+  void addSymbol(SymbolId symbol, const Expression& exp);
+
+  /**
+   * Adds a symbol and its expression to the environment, moving the expression into the
+   * symbol table instead of copying it.
+   */
+  void addSymbol(SymbolId symbol, Expression&& exp);
+
   /**
    * Retrieves the expression associated with a given symbol from the environment.
    *
    * This function takes a string representing the symbol name as input.
-   * It searches the symbol table for the corresponding entry and returns the associated expression.
+   * It searches the symbol table for the corresponding entry and returns a reference to the
+   * associated expression, which stays valid until the next symbol is added or the environment is reset.
    *
    * If the symbol is not found in the environment, the function throws an `InterpreterSemanticError`
     exception with an informative message.
    */
-  Expression getExpression(const std::string& symbol) const;
+  const Expression& getExpression(const std::string& symbol) const;
+
+  /**
+   * Retrieves the expression associated with a symbol given by its interned id.
+   */
+  const Expression& getExpression(SymbolId symbol) const;
 
   /**
    * Checks if a given symbol exists in the environment's symbol table.
@@ -48,11 +67,16 @@ public:
    */
   bool symbolExists(const std::string& symbol) const;
 
+  /**
+   * Checks if a symbol given by its interned id exists in the environment's symbol table.
+   */
+  bool symbolExists(SymbolId symbol) const;
+
   /**
    * Resets the environment to its initial state.
    *
    * This function clears the internal symbol table, effectively removing all previously added symbols
-    and their associated expressions from the environment.
+    and their associated expressions from the environment. The builtin constants are kept.
    */
   void resetEnvironment();
 
@@ -61,19 +85,21 @@ public:
    *
    * This function is not part of the public interface and is used internally by other methods within
    the `Environment` class.
-   * It takes a string representing the symbol name and searches the symbol table. If found, it returns
-    the associated expression, otherwise throws an `InterpreterSemanticError` exception.
+   * It takes a symbol id and looks it up in the symbol table. If found, it returns a pointer to
+    the associated expression, otherwise a null pointer, so a lookup never copies the value.
    */
-  Expression find(const std::string& key) const;
+  const Expression* find(SymbolId key) const;
 
 private:
   /**
    * Internal symbol table used to store variables (symbols) and their corresponding expressions.
    *
    * This member variable is declared as private as it should only be accessed within the `Environment`
-    class. It uses an `unordered_map` to efficiently store and retrieve symbol-expression pairs.
+    class. Symbol ids are dense, so the table is indexed directly by `SymbolId::value` and a
+    lookup costs a bounds check and a flag test. `bound` records which entries hold a value.
    */
-  std::unordered_map<std::string, Expression> symbolTable;
+  std::vector<Expression> symbolTable;
+  std::vector<uint8_t> bound;
 };
 
 #endif // ENVIRONMENT_HPP // Guard against multiple inclusions
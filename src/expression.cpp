@@ -1,17 +1,132 @@
 #include "expression.hpp" // Include header file for Expression class
+#include "procedure.hpp"  // Include header file for releaseLambda
+#include <new>            // Include new for placement new
+#include <utility>        // Include utility for std::swap
+#include <vector>         // Include vector for the work lists of copy, comparison and destruction
 
 /**
  * This header file defines the implementation of the `Expression` class,
  * which represents various expressions within the Slisp interpreter.
  */
 
+static_assert(sizeof(Expression) <= 16, "Expression should stay two machine words wide");
+
+namespace {
+
+  /**
+   * Checks whether `exp` is a list whose storage is owned by the expression itself.
+   */
+  bool ownsList(const Expression& exp) {
+    return exp.type == AtomType::None && exp.list != nullptr && !exp.list->arenaOwned;
+  }
+
+  /**
+   * Checks whether `exp` holds the last reference to a closure.
+   */
+  bool ownsClosure(const Expression& exp) {
+    return exp.type == AtomType::Procedure && exp.closure->references == 1;
+  }
+
+  /**
+   * Frees heap child storage or a closure no longer referred to, together with every heap list
+   * and closure they own in turn.
+   *
+   * Owned children are detached from their parents and freed from work lists, so freeing a deeply
+   * nested list, or a long chain of closures capturing each other, does not recurse once per level.
+   */
+  void release(ListStorage* list, Closure* closure) {
+    std::vector<ListStorage*> lists;
+    std::vector<Closure*> closures;
+    auto detach = [&](Expression& item) {
+      if (ownsList(item)) {
+        lists.push_back(item.list);
+      } else if (ownsClosure(item)) {
+        closures.push_back(item.closure);
+      } else {
+        return;
+      }
+      item.type = AtomType::None;
+      item.list = nullptr;
+    };
+    while (true) {
+      if (list != nullptr) {
+        for (Expression& item : list->items) {
+          detach(item);
+        }
+        delete list;
+      } else {
+        for (Expression& item : closure->captured) {
+          detach(item);
+        }
+        releaseLambda(closure->lambda);
+        delete closure;
+      }
+      list = nullptr;
+      closure = nullptr;
+      if (!lists.empty()) {
+        list = lists.back();
+        lists.pop_back();
+      } else if (!closures.empty()) {
+        closure = closures.back();
+        closures.pop_back();
+      } else {
+        return;
+      }
+    }
+  }
+
+  /**
+   * Fills `copy`, an empty heap list, with a deep copy of the children in `source`.
+   *
+   * Like `release`, nested lists are handled from a work list rather than by recursion.
+   */
+  void copyList(const ListStorage& source, ListStorage& copy) {
+    struct Pending {
+      const ListStorage* source;
+      ListStorage* copy;
+    };
+    std::vector<Pending> pending;
+    Pending current{&source, &copy};
+    while (true) {
+      ExpressionList& items = current.copy->items;
+      items.reserve(current.source->items.size());
+      for (const Expression& item : current.source->items) {
+        if (item.type == AtomType::None && item.list != nullptr) {
+          Expression& child = items.emplace_back();
+          child.list = new ListStorage{ExpressionList(), false};
+          pending.push_back(Pending{item.list, child.list});
+#ifdef SLISP_COUNT_COPIES
+          ++expressionCopyCounts().lists;
+#endif
+        } else {
+          items.push_back(item);
+        }
+      }
+      if (pending.empty()) {
+        return;
+      }
+      current = pending.back();
+      pending.pop_back();
+    }
+  }
+}
+
+#ifdef SLISP_COUNT_COPIES
+/**
+ * Returns the process-wide copy counters.
+ */
+ExpressionCopyCounts& expressionCopyCounts() {
+  static ExpressionCopyCounts counts = {0, 0};
+  return counts;
+}
+#endif
+
 /**
  * Default constructor for the Expression class.
  *
- * This constructor creates an expression of type `None` with default boolean
- * and numerical values set to false and 0.0, respectively.
+ * This constructor creates an expression of type `None` with no children.
  */
-Expression::Expression() : type(AtomType::None), boolValue(false), numValue(0.0) {}
+Expression::Expression() noexcept : type(AtomType::None), list(nullptr) {}
 
 /**
  * Constructor for creating boolean expressions.
@@ -19,7 +134,9 @@ Expression::Expression() : type(AtomType::None), boolValue(false), numValue(0.0)
  * This constructor takes a boolean value as input and creates an expression
  * of type `Boolean` with the specified boolean value.
  */
-Expression::Expression(bool value) : type(AtomType::Boolean), boolValue(value), numValue(0.0) {}
+Expression::Expression(bool value) : type(AtomType::Boolean), list(nullptr) {
+  boolValue = value;
+}
 
 /**
  * Constructor for creating numerical expressions.
@@ -27,7 +144,7 @@ Expression::Expression(bool value) : type(AtomType::Boolean), boolValue(value),
  * This constructor takes a double-precision floating-point value as input
  * and creates an expression of type `Number` with the specified value.
  */
-Expression::Expression(double value) : type(AtomType::Number), boolValue(false), numValue(value) {}
+Expression::Expression(double value) : type(AtomType::Number), numValue(value) {}
 
 /**
  * Constructor for creating symbolic expressions.
@@ -35,7 +152,119 @@ Expression::Expression(double value) : type(AtomType::Number), boolValue(false),
  * This constructor takes a string as input and creates an expression of type
  * `Symbol` with the specified string value.
  */
-Expression::Expression(const std::string& value) : type(AtomType::Symbol), boolValue(false), numValue(0.0), symValue(value) {}
+Expression::Expression(const std::string& value) : type(AtomType::Symbol), list(nullptr) {
+  symbol = internSymbol(value);
+}
+
+/**
+ * Constructor for creating symbolic expressions from an id returned by `internSymbol`.
+ */
+Expression::Expression(SymbolId id) : type(AtomType::Symbol), list(nullptr) {
+  symbol = id;
+}
+
+/**
+ * Constructor for creating procedure expressions. Takes over one reference to `closure`.
+ */
+Expression::Expression(Closure* closure) : type(AtomType::Procedure) {
+  this->closure = closure;
+}
+
+/**
+ * Constructor for creating list expressions in an arena.
+ *
+ * The child storage is constructed in place inside the arena and marked as arena-owned.
+ */
+Expression::Expression(Arena& arena) : type(AtomType::None) {
+  void* storage = arena.allocate(sizeof(ListStorage), alignof(ListStorage));
+  list = new (storage) ListStorage{ExpressionList(ArenaAllocator<Expression>(&arena)), true};
+}
+
+/**
+ * Copy constructor. Child lists are copied deeply onto the heap, without recursion, and
+ * procedures share their closure.
+ */
+Expression::Expression(const Expression& exp) : type(exp.type), numValue(exp.numValue) {
+  // Copying `numValue` copies whichever member of the union is live; lists are then replaced
+  // by a private copy so the two expressions never share child storage
+  if (type == AtomType::None && list != nullptr) {
+    // The copy is built under a temporary owner, so it is freed if copying throws
+    Expression copy;
+    copy.list = new ListStorage{ExpressionList(), false};
+    copyList(*exp.list, *copy.list);
+    list = copy.list;
+    copy.list = nullptr;
+  } else if (type == AtomType::Procedure) {
+    ++closure->references;
+  }
+#ifdef SLISP_COUNT_COPIES
+  if (type == AtomType::None) {
+    ++expressionCopyCounts().lists;
+  } else {
+    ++expressionCopyCounts().atoms;
+  }
+#endif
+}
+
+/**
+ * Move constructor. Takes over the child storage of `exp`, leaving it of type `None`.
+ */
+Expression::Expression(Expression&& exp) noexcept : type(exp.type), numValue(exp.numValue) {
+  exp.type = AtomType::None;
+  exp.list = nullptr;
+}
+
+/**
+ * Assignment operator covering both copy and move assignment.
+ *
+ * The argument is taken by value, so copying or moving happens before this expression is
+ * modified, and the old value is released when the argument goes out of scope.
+ */
+Expression& Expression::operator=(Expression exp) noexcept {
+  std::swap(type, exp.type);
+  std::swap(numValue, exp.numValue);
+  return *this;
+}
+
+/**
+ * Destructor. Frees heap-allocated child storage, and closures no other expression refers to,
+ * without recursion.
+ */
+Expression::~Expression() {
+  if (ownsList(*this)) {
+    release(list, nullptr);
+  } else if (ownsClosure(*this)) {
+    release(nullptr, closure);
+  } else if (type == AtomType::Procedure) {
+    --closure->references;
+  }
+}
+
+/**
+ * Returns the name of a `Symbol` expression.
+ */
+const std::string& Expression::symValue() const {
+  return symbolName(symbol);
+}
+
+/**
+ * Returns the child expressions; empty for atoms.
+ */
+const ExpressionList& Expression::children() const {
+  static const ExpressionList empty;
+  return type == AtomType::None && list != nullptr ? list->items : empty;
+}
+
+/**
+ * Returns the child expressions of a `None` expression for modification, creating heap
+ * storage for them on first use.
+ */
+ExpressionList& Expression::children() {
+  if (list == nullptr) {
+    list = new ListStorage{ExpressionList(), false};
+  }
+  return list->items;
+}
 
 /**
  * Equality comparison operator for Expression objects.
@@ -45,8 +274,51 @@ Expression::Expression(const std::string& value) : type(AtomType::Symbol), boolV
  * It is declared as noexcept to indicate that it does not throw any exceptions.
  */
 bool Expression::operator==(const Expression& exp) const noexcept {
-  // Compare all relevant member variables for equality
-  return type == exp.type && boolValue == exp.boolValue && numValue == exp.numValue && symValue == exp.symValue && children == exp.children;
+  // Compare the type first, then only the member of the union that is live for it
+  if (type != exp.type) {
+    return false;
+  }
+  switch (type) {
+    case AtomType::Boolean:
+      return boolValue == exp.boolValue;
+    case AtomType::Number:
+      return numValue == exp.numValue;
+    case AtomType::Symbol:
+      return symbol == exp.symbol; // Interned, so equal names share one id
+    case AtomType::Procedure:
+      return closure == exp.closure; // The same procedure, not just the same code
+    default:
+      break;
+  }
+
+  // Lists are compared element by element; nested lists are compared from a work list rather
+  // than by recursion
+  std::vector<std::pair<const ExpressionList*, const ExpressionList*>> pending;
+  const ExpressionList* left = &children();
+  const ExpressionList* right = &exp.children();
+  while (true) {
+    if (left->size() != right->size()) {
+      return false;
+    }
+    for (size_t i = 0; i < left->size(); ++i) {
+      const Expression& a = (*left)[i];
+      const Expression& b = (*right)[i];
+      if (a.type != b.type) {
+        return false;
+      }
+      if (a.type == AtomType::None) {
+        pending.emplace_back(&a.children(), &b.children());
+      } else if (!(a == b)) {
+        return false;
+      }
+    }
+    if (pending.empty()) {
+      return true;
+    }
+    left = pending.back().first;
+    right = pending.back().second;
+    pending.pop_back();
+  }
 }
 
 /**
@@ -64,7 +336,9 @@ std::string Expression::getStringRepresentation() const {
     case AtomType::Number:
       return std::to_string(numValue); // Convert double to string (adjust precision if needed)
     case AtomType::Symbol:
-      return symValue;
+      return symbolName(symbol);
+    case AtomType::Procedure:
+      return "Procedure";
     default:
       return "Unknown"; // Handle other cases if necessary
   }
@@ -4,6 +4,20 @@
 #include <string>       // Include string library for `std::string`
 #include <vector>        // Include vector library for `std::vector`
 #include <iostream>      // Include iostream library for `std::ostream`
+#include "arena.hpp"     // Include header file for ArenaAllocator
+#include "small_vector.hpp" // Include header file for SmallVector
+#include "symbol_table.hpp" // Include header file for SymbolId
+
+/**
+ * Number of children a list stores inside its own child storage before it allocates more.
+ *
+ * Most lists in Slisp programs are short procedure calls such as `(+ 1 2)`, so four covers
+ * the common case. Building with `-DSLISP_INLINE_CHILDREN=0` turns the inline storage off,
+ * which is useful for comparing allocation counts.
+ */
+#ifndef SLISP_INLINE_CHILDREN
+#define SLISP_INLINE_CHILDREN 4
+#endif
 
 /**
  * This header file defines the `Expression` class and related elements used within the Slisp interpreter.
@@ -13,18 +27,58 @@
  * Enumeration that defines different atom types for expressions.
  *
  * This enum defines the possible types an `Expression` object can have:
- *  - None: Represents the absence of a value.
+ *  - None: Represents the absence of a value, or a list when the expression has children.
  *  - Boolean: Represents a true or false value.
  *  - Number: Represents a numerical value (double-precision floating-point).
  *  - Symbol: Represents a symbolic value (string).
+ *  - Procedure: Represents a procedure made by evaluating a `lambda` form (see `Closure`).
+ */
+enum class AtomType { None, Boolean, Number, Symbol, Procedure };
+
+struct Expression;
+struct ListStorage;
+struct Closure;
+
+/**
+ * Container type for the children of an `Expression`.
+ *
+ * The first `SLISP_INLINE_CHILDREN` children are stored inline, so a short list costs a single
+ * allocation for its `ListStorage`. Longer lists spill to the heap by default; lists built by
+ * the parser draw from the interpreter's `Arena` instead, so a whole program is laid out in a
+ * few contiguous blocks.
+ */
+typedef SmallVector<Expression, SLISP_INLINE_CHILDREN, ArenaAllocator<Expression>> ExpressionList;
+
+#ifdef SLISP_COUNT_COPIES
+/**
+ * Copy counters maintained by instrumentation builds (configure with `-DSLISP_COUNT_COPIES=ON`).
+ *
+ *  - atoms: copies of numbers, booleans and symbols, which never allocate.
+ *  - lists: copies of composite expressions. Copying a list copies its whole subtree, so every
+ *    expression below it is counted as well.
+ *
+ * The counters are not synchronized and are only meant for single-threaded measurements.
+ */
+struct ExpressionCopyCounts {
+  size_t atoms;
+  size_t lists;
+};
+
+/**
+ * Returns the process-wide copy counters.
  */
-enum class AtomType { None, Boolean, Number, Symbol };
+ExpressionCopyCounts& expressionCopyCounts();
+#endif
 
 /**
  * This struct defines the `Expression` class, which represents various expressions
  * within the Slisp interpreter.
  *
  * An `Expression` object can be atomic (having a single value) or composite (containing multiple child expressions).
+ *
+ * The value is a tagged union: `type` says which member of the union is live. Numbers and
+ * booleans are stored inline, symbols are stored as their interned id, and child lists and
+ * procedures live out of line, so every expression is 16 bytes regardless of its type.
  */
 struct Expression {
   /**
@@ -32,33 +86,40 @@ struct Expression {
    */
   AtomType type;
 
-  /**
-   * Boolean value for expressions of type `Boolean`.
-   */
-  bool boolValue;
+  union {
+    /**
+     * Boolean value for expressions of type `Boolean`.
+     */
+    bool boolValue;
 
-  /**
-   * Numerical value for expressions of type `Number`.
-   */
-  double numValue;
+    /**
+     * Numerical value for expressions of type `Number`.
+     */
+    double numValue;
 
-  /**
-   * Symbolic value for expressions of type `Symbol`.
-   */
-  std::string symValue;
+    /**
+     * Interned id for expressions of type `Symbol` (see `internSymbol`).
+     */
+    SymbolId symbol;
 
-  /**
-   * Vector of child expressions, used for representing composite expressions.
-   */
-  std::vector<Expression> children;
+    /**
+     * Out-of-line child storage for composite expressions of type `None`, or null when there
+     * are no children.
+     */
+    ListStorage* list;
+
+    /**
+     * Counted reference to the closure of expressions of type `Procedure`.
+     */
+    Closure* closure;
+  };
 
   /**
    * Default constructor for the `Expression` class.
    *
-   * This constructor creates an expression of type `None` with default
-   * boolean and numerical values set to false and 0.0, respectively.
+   * This constructor creates an expression of type `None` with no children.
    */
-  Expression();
+  Expression() noexcept;
 
   /**
    * Constructor for creating boolean expressions.
@@ -84,6 +145,67 @@ struct Expression {
    */
   Expression(const std::string& value);
 
+  /**
+   * Constructor for creating symbolic expressions from an id returned by `internSymbol`.
+   *
+   * This avoids looking the name up again when it has already been interned.
+   */
+  explicit Expression(SymbolId id);
+
+  /**
+   * Constructor for creating procedure expressions. Takes over one reference to `closure`.
+   */
+  explicit Expression(Closure* closure);
+
+  /**
+   * Constructor for creating list expressions in an arena.
+   *
+   * This constructor creates an empty expression of type `None` whose child storage is
+   * allocated from `arena`. Such a list is never destroyed individually: its memory is
+   * reclaimed by `Arena::reset`, so it must only be given atoms or lists from the same arena.
+   * Copies of the expression are always allocated on the heap.
+   */
+  explicit Expression(Arena& arena);
+
+  /**
+   * Copy constructor. Child lists are copied deeply onto the heap; procedures are shared.
+   */
+  Expression(const Expression& exp);
+
+  /**
+   * Move constructor. Takes over the child storage of `exp`, leaving it of type `None`.
+   */
+  Expression(Expression&& exp) noexcept;
+
+  /**
+   * Assignment operator covering both copy and move assignment.
+   */
+  Expression& operator=(Expression exp) noexcept;
+
+  /**
+   * Destructor. Frees heap-allocated child storage, and closures no other expression refers to.
+   */
+  ~Expression();
+
+  /**
+   * Returns the name of a `Symbol` expression.
+   *
+   * This resolves the id through the symbol table, so it is meant for printing; compare
+   * `symbol` ids instead of names.
+   */
+  const std::string& symValue() const;
+
+  /**
+   * Returns the child expressions; empty for atoms.
+   */
+  const ExpressionList& children() const;
+
+  /**
+   * Returns the child expressions of a `None` expression for modification, creating heap
+   * storage for them on first use.
+   */
+  ExpressionList& children();
+
   /**
    * Equality comparison operator for `Expression` objects.
    *
@@ -102,6 +224,34 @@ struct Expression {
   std::string getStringRepresentation() const;
 };
 
+/**
+ * Out-of-line child storage of a composite `Expression`.
+ *
+ * `arenaOwned` is set when the storage was allocated from an `Arena`, in which case the
+ * owning expression does not free it.
+ */
+struct ListStorage {
+  ExpressionList items;
+  bool arenaOwned;
+};
+
+struct Lambda;
+
+/**
+ * A procedure value: the code of a `lambda` form (see `procedure.hpp`) together with the values
+ * of the variables of enclosing procedures that its body uses, copied into a flat array when
+ * the form was evaluated. Variables defined with `define` are looked up when the body runs
+ * instead, so they are not captured.
+ *
+ * Closures are immutable once made, so they are shared by copies of the expressions referring
+ * to them, and freed with the last one. A closure never refers to itself.
+ */
+struct Closure {
+  uint32_t references;
+  Lambda* lambda;                   // Counted reference
+  std::vector<Expression> captured; // Indexed by the slots of `Lambda::captures`
+};
+
 /**
  * Overloaded output stream operator for `Expression` objects.
  *
@@ -0,0 +1,127 @@
+#include "flat_ast.hpp" // Include header file for FlatAst class
+
+/**
+ * Replaces the contents with the flattened form of `root`.
+ *
+ * Nodes are appended in pre-order. A list's `ends` entry is filled in once all of its children
+ * have been appended.
+ */
+void FlatAst::assign(const Expression& root) {
+  clear();
+
+  struct Pending {
+    const Expression* list;
+    size_t nextChild;
+    uint32_t node;
+  };
+  std::vector<Pending> stack;
+
+  auto append = [&](const Expression& exp) {
+    uint32_t node = static_cast<uint32_t>(types.size());
+    types.push_back(exp.type);
+    ends.push_back(node + 1);
+    switch (exp.type) {
+      case AtomType::Number:
+        payloads.push_back(static_cast<uint32_t>(numbers.size()));
+        numbers.push_back(exp.numValue);
+        break;
+      case AtomType::Boolean:
+        payloads.push_back(static_cast<uint32_t>(booleans.size()));
+        booleans.push_back(exp.boolValue ? 1 : 0);
+        break;
+      case AtomType::Symbol:
+        payloads.push_back(static_cast<uint32_t>(symbols.size()));
+        symbols.push_back(exp.symbol);
+        break;
+      default:
+        payloads.push_back(static_cast<uint32_t>(exp.children().size()));
+        stack.push_back(Pending{&exp, 0, node});
+        break;
+    }
+  };
+
+  append(root);
+  while (!stack.empty()) {
+    Pending& top = stack.back();
+    if (top.nextChild < top.list->children().size()) {
+      const Expression& child = top.list->children()[top.nextChild++];
+      append(child); // May grow the stack, so `top` is not used afterwards
+    } else {
+      ends[top.node] = static_cast<uint32_t>(types.size());
+      stack.pop_back();
+    }
+  }
+}
+
+/**
+ * Removes every node.
+ */
+void FlatAst::clear() {
+  types.clear();
+  ends.clear();
+  payloads.clear();
+  numbers.clear();
+  booleans.clear();
+  symbols.clear();
+}
+
+/**
+ * Returns the number of nodes.
+ */
+uint32_t FlatAst::size() const {
+  return static_cast<uint32_t>(types.size());
+}
+
+/**
+ * Returns the name of a symbol node.
+ */
+const std::string& FlatAst::symbolName(uint32_t node) const {
+  return ::symbolName(symbol(node));
+}
+
+/**
+ * Returns the interned id of a symbol node (see `internSymbol`).
+ */
+SymbolId FlatAst::symbol(uint32_t node) const {
+  return symbols[payloads[node]];
+}
+
+/**
+ * Returns the subtree rooted at `node` as an expression on the heap.
+ *
+ * Every list reserves room for all of its children before any is added, so the pointers to
+ * lists still waiting for their children stay valid.
+ */
+Expression FlatAst::expression(uint32_t node) const {
+  auto atom = [&](uint32_t child) {
+    switch (types[child]) {
+      case AtomType::Number: return Expression(numbers[payloads[child]]);
+      case AtomType::Boolean: return Expression(booleans[payloads[child]] != 0);
+      default: return Expression(symbol(child));
+    }
+  };
+  if (types[node] != AtomType::None) {
+    return atom(node);
+  }
+
+  struct Pending {
+    Expression* list;
+    uint32_t node;
+  };
+  Expression root;
+  std::vector<Pending> stack{Pending{&root, node}};
+  while (!stack.empty()) {
+    Pending current = stack.back();
+    stack.pop_back();
+    ExpressionList& items = current.list->children();
+    items.reserve(payloads[current.node]);
+    for (uint32_t child = current.node + 1; child < ends[current.node]; child = ends[child]) {
+      if (types[child] == AtomType::None) {
+        stack.push_back(Pending{&items.emplace_back(), child});
+      } else {
+        items.push_back(atom(child));
+      }
+    }
+  }
+  return root;
+}
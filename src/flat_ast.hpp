@@ -0,0 +1,71 @@
+#ifndef FLAT_AST_HPP // Prevent multiple inclusions
+#define FLAT_AST_HPP   // Define a unique identifier for the header file
+
+#include <cstdint>    // Include cstdint for node indices
+#include <string>     // Include string library for symbol names
+#include <vector>     // Include vector library for the node arrays
+#include "expression.hpp" // Include header file for Expression class
+
+/**
+ * This header file defines the `FlatAst` class, a contiguous, index-based layout of a parsed
+ * program that the interpreter evaluates instead of chasing `Expression` pointers.
+ */
+
+/**
+ * A parsed program stored as parallel arrays of nodes in pre-order.
+ *
+ * Node 0 is the root. The children of a list node `n` are stored right after it: the first
+ * child is `n + 1` and every child's next sibling is `ends[child]`, so the span
+ * `[n + 1, ends[n])` covers exactly the subtree below `n`. Node payloads are kept out of the
+ * node arrays in separate typed arrays:
+ *  - types: the `AtomType` of each node (`None` for lists, as in `Expression`).
+ *  - ends: one past the last node of each node's subtree.
+ *  - payloads: for lists the number of children, otherwise an index into the typed array
+ *    matching the node's type.
+ *  - numbers / booleans / symbols: the atom values; `symbols` holds interned symbol ids.
+ */
+class FlatAst {
+public:
+  std::vector<AtomType> types;
+  std::vector<uint32_t> ends;
+  std::vector<uint32_t> payloads;
+  std::vector<double> numbers;
+  std::vector<uint8_t> booleans;
+  std::vector<SymbolId> symbols;
+
+  /**
+   * Replaces the contents with the flattened form of `root`.
+   *
+   * The tree is walked with an explicit stack, so deep nesting cannot overflow the C++ stack.
+   * Existing array capacity is kept, so re-flattening programs of similar size does not allocate.
+   */
+  void assign(const Expression& root);
+
+  /**
+   * Removes every node.
+   */
+  void clear();
+
+  /**
+   * Returns the number of nodes.
+   */
+  uint32_t size() const;
+
+  /**
+   * Returns the name of a symbol node.
+   */
+  const std::string& symbolName(uint32_t node) const;
+
+  /**
+   * Returns the interned id of a symbol node (see `internSymbol`).
+   */
+  SymbolId symbol(uint32_t node) const;
+
+  /**
+   * Returns the subtree rooted at `node` as an expression whose lists are stored on the heap,
+   * so it outlives the program. Built without recursion, like `assign`.
+   */
+  Expression expression(uint32_t node) const;
+};
+
+#endif // FLAT_AST_HPP // Guard against multiple inclusions
@@ -0,0 +1,97 @@
+#include "form_reader.hpp" // Include header file for FormReader class
+
+/**
+ * This namespace contains helper functions used by the `FormReader` class.
+ *
+ *  * `isWhitespace(char c)`: Checks if a character is whitespace (space, tab, newline, or carriage return).
+ */
+namespace {
+
+  bool isWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+  }
+}
+
+/**
+ * Constructor for the `FormReader` class.
+ *
+ * This constructor allocates the refill buffer once; it is never grown afterwards.
+ */
+FormReader::FormReader(std::istream& input, size_t bufferSize)
+  : input(input), buffer(bufferSize > 0 ? bufferSize : 1), position(0), available(0) {}
+
+/**
+ * Reads the next complete top-level form.
+ *
+ * The function walks the buffered input one character at a time, tracking the parenthesis
+ * depth and whether it is inside a comment:
+ *  1. Outside of a form, whitespace and comments are skipped.
+ *  2. Inside a list, every character except comment text is copied to `form`, and the form is
+ *     returned as soon as the closing parenthesis brings the depth back to zero.
+ *  3. A top-level atom ends at the first delimiter, which is left in the buffer for the next call.
+ *
+ * Whenever the buffer is exhausted it is refilled from the stream, so only the current form is
+ * ever held in memory.
+ */
+bool FormReader::next(std::string& form) {
+  form.clear();
+  size_t depth = 0;
+  bool inComment = false;
+  bool inAtom = false;
+
+  while (position < available || refill()) {
+    char c = buffer[position];
+
+    if (inComment) {
+      if (c == '\n') {
+        inComment = false;
+        if (depth > 0) {
+          form.push_back(c); // Keep the newline so line numbers stay correct
+        }
+      }
+      ++position;
+    } else if (inAtom && (isWhitespace(c) || c == '(' || c == ')' || c == ';')) {
+      return true;
+    } else if (c == ';') {
+      inComment = true;
+      ++position;
+    } else if (c == '(') {
+      ++depth;
+      form.push_back(c);
+      ++position;
+    } else if (c == ')') {
+      ++position;
+      if (depth == 0) {
+        throw InterpreterSemanticError("Error: unexpected ')'");
+      }
+      form.push_back(c);
+      if (--depth == 0) {
+        return true;
+      }
+    } else if (isWhitespace(c)) {
+      if (depth > 0) {
+        form.push_back(c);
+      }
+      ++position;
+    } else {
+      inAtom = inAtom || depth == 0;
+      form.push_back(c);
+      ++position;
+    }
+  }
+
+  if (depth > 0) {
+    throw InterpreterSemanticError("Error: unexpected end of input inside a form");
+  }
+  return inAtom;
+}
+
+/**
+ * Reads the next chunk of the stream into the buffer. Returns `false` at end of stream.
+ */
+bool FormReader::refill() {
+  input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+  available = static_cast<size_t>(input.gcount());
+  position = 0;
+  return available > 0;
+}
@@ -0,0 +1,53 @@
+#ifndef FORM_READER_HPP // Prevent multiple inclusions
+#define FORM_READER_HPP   // Define a unique identifier for the header file
+
+#include <cstddef>    // Include cstddef for size_t
+#include <istream>    // Include istream for the input stream
+#include <string>     // Include string library for the form text
+#include <vector>     // Include vector library for the refill buffer
+#include "interpreter_semantic_error.hpp" // Include header file for InterpreterSemanticError class
+
+/**
+ * This header file defines the `FormReader` class, which splits a stream of Slisp source into
+ * complete top-level forms without reading the whole stream into memory.
+ */
+class FormReader {
+public:
+  /**
+   * Default size of the refill buffer in bytes.
+   */
+  static const size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+  /**
+   * Constructor for the `FormReader` class.
+   *
+   * This constructor takes the stream to read from and the size of the fixed refill buffer.
+   * The stream must outlive the reader.
+   */
+  explicit FormReader(std::istream& input, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+  /**
+   * Reads the next complete top-level form.
+   *
+   * A form is either a parenthesized list, returned as soon as its parentheses balance, or a
+   * single top-level atom. Comments and whitespace between forms are dropped. The text of the
+   * form is stored in `form`, which is reused, so memory stays proportional to the largest form.
+   *
+   * Returns `false` once the stream is exhausted. Throws an `InterpreterSemanticError` if a
+   * closing parenthesis has no matching opening one or the stream ends inside a form.
+   */
+  bool next(std::string& form);
+
+private:
+  /**
+   * Reads the next chunk of the stream into the buffer. Returns `false` at end of stream.
+   */
+  bool refill();
+
+  std::istream& input;
+  std::vector<char> buffer;
+  size_t position;
+  size_t available;
+};
+
+#endif // FORM_READER_HPP // Guard against multiple inclusions
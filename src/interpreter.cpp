@@ -1,169 +1,481 @@
 #include "interpreter_semantic_error.hpp"
 #include "interpreter.hpp"
 #include "tokenize.hpp"
-#include <stack>
+#include "form_reader.hpp"
+#include "mapped_file.hpp"
+#include "analysis.hpp"
+#include "optimizer.hpp"
+#include "type_inference.hpp"
+#include "bytecode.hpp"
+#include "vm.hpp"
+#include "procedure.hpp"
+#include "aot.hpp"
+#include <utility>
 
 
-Interpreter::Interpreter() {
+Interpreter::Interpreter() : analyzed(false), machine(environment), engine(EvaluationEngine::Bytecode),
+                             depthLimit(DEFAULT_DEPTH_LIMIT) {
   // Initialize the interpreter if needed
 }
 
 Expression Interpreter::eval() {
-  // TODO: Implement AST evaluation logic
-  // Use the environment and evaluateExpression method
+  // Analyze, optimize and compile the program once, before its first evaluation, so that both engines
+  // report semantic errors up front and later evaluations skip straight to the work
+  if (!analyzed && program.size() != 0) {
+    analyzeProgram(program, nodes, lambdas, depthLimit);
+    optimizeProgram(program, environment, nodes, folded);
+    inferTypes(program, environment, nodes, folded, types);
+    compileProgram(program, nodes, lambdas, folded, types, code);
+    lambdaForms.clear();
+    collectLambdaForms(ast, lambdaForms); // In the order of `code.lambdas`
+    analyzed = true;
+  }
+
+  // Evaluate the program stored by the last successful parse
+  if (program.size() == 0) {
+    return Expression();
+  }
+  if (engine == EvaluationEngine::Tree) {
+    return evaluateExpression(ast);
+  }
+  return machine.run(code);
+}
+
+void Interpreter::setEngine(EvaluationEngine selected) {
+  engine = selected;
+}
+
+void Interpreter::setDepthLimit(size_t limit) {
+  depthLimit = limit;
+  machine.setDepthLimit(limit);
+  analyzed = false; // Analyze again, so the program is checked against the new limit
+}
+
+void Interpreter::setJit(bool enabled) {
+  machine.setJit(enabled);
+}
+
+void Interpreter::translate(const std::string& function, std::ostream& source) {
+  // Prove types against a fresh environment rather than this one, since the translated function
+  // may be called with any environment
+  Environment fresh;
+  std::vector<NodeInfo> translatedNodes;
+  std::vector<LambdaInfo> translatedLambdas;
+  std::vector<Expression> translatedFolded;
+  std::vector<StaticType> translatedTypes;
+  Bytecode translatedCode;
+  if (program.size() != 0) {
+    analyzeProgram(program, translatedNodes, translatedLambdas, depthLimit);
+    optimizeProgram(program, fresh, translatedNodes, translatedFolded);
+    inferTypes(program, fresh, translatedNodes, translatedFolded, translatedTypes);
+    compileProgram(program, translatedNodes, translatedLambdas, translatedFolded, translatedTypes, translatedCode);
+  }
+  translateProgram(translatedCode, function, source);
+}
 
-  return Expression(); // Return the result of the evaluation
+void Interpreter::releaseProgram() {
+  // The old AST must be destroyed while its arena memory is still intact
+  ast = Expression();
+  program.clear();
+  nodes.clear();
+  lambdas.clear();
+  lambdaForms.clear();
+  folded.clear();
+  types.clear();
+  code.clear();
+  analyzed = false;
+  arena.reset();
+}
+
+void Interpreter::loadProgram(const char * data, size_t size) {
+  releaseProgram();
+  ast = parseExpression(data, size);
+
+  // Lay the program out flat once, so repeated evaluation walks contiguous arrays
+  program.assign(ast);
 }
 
 Expression Interpreter::parseExpression(std::string & expression) {
-  std::vector < std::string > tokens = tokenize(expression);
+  return parseExpression(expression.data(), expression.size());
+}
 
-  // Create a stack to build the AST
-  std::stack < Expression > stack;
+Expression Interpreter::parseExpression(const char * data, size_t size) {
+  // Tokens are views into `data`, so the buffer is never copied into token strings
+  scanTokens(data, size, tokens);
+
+  // Each list that is still open has a frame on this stack. Atoms and finished lists are
+  // appended to the innermost open frame in order, so every child is placed exactly once
+  // and whole subtrees are moved rather than copied.
+  std::vector < Expression > frames;
+  Expression program;
+  bool complete = false;
 
   for (const auto & token: tokens) {
-    if (token == "(") {
-      stack.push(Expression());
-    } else if (token == ")") {
-      Expression currentExpression;
-      while (!stack.empty() && stack.top().type != AtomType::None) {
-        currentExpression.children.insert(currentExpression.children.begin(), stack.top());
-        stack.pop();
-      }
-      stack.pop(); // Pop the opening parenthesis
+    if (complete) {
+      throw InterpreterSemanticError("Error: unexpected input after the end of the program");
+    }
 
-      // Check for special forms and procedures and handle accordingly
-      // TODO: Implement special form and procedure handling
+    Expression atom;
+    if (token.type == Token::OPEN_PAREN) {
+      frames.emplace_back(arena);
+      continue;
+    } else if (token.type == Token::CLOSE_PAREN) {
+      if (frames.empty()) {
+        throw InterpreterSemanticError("Error: unexpected ')'");
+      }
+      if (frames.size() == 1 && frames.back().children().empty()) {
+        throw InterpreterSemanticError("Error: empty program");
+      }
+      atom = std::move(frames.back());
+      frames.pop_back();
+    } else if (token.type == Token::NUMBER) {
+      // The tokenizer already classified the atom, so it can be converted directly
+      atom = Expression(tokenNumber(token, data));
+    } else if (token.type == Token::BOOLEAN) {
+      atom = Expression(tokenBoolean(token, data));
+    } else if (token.type == Token::SYMBOL) {
+      atom = Expression(token.symbol); // Interned by the tokenizer
+    } else {
+      throw InterpreterSemanticError("Error: invalid token " + tokenText(token, data));
+    }
 
-      // Push the constructed expression onto the stack
-      stack.push(currentExpression);
+    if (!frames.empty()) {
+      frames.back().children().push_back(std::move(atom));
+    } else if (token.type == Token::CLOSE_PAREN) {
+      program = std::move(atom);
+      complete = true;
     } else {
-      // For numbers and symbols, create an atom and push onto the stack
-      stack.push(Expression(token));
+      throw InterpreterSemanticError("Error: a program must be a list");
     }
   }
 
-  // The top of the stack should now contain the fully constructed AST
-  return stack.top();
+  if (!frames.empty()) {
+    throw InterpreterSemanticError("Error: unexpected end of input");
+  }
+  if (!complete) {
+    throw InterpreterSemanticError("Error: empty program");
+  }
+  return program;
 }
 
 Expression Interpreter::evaluateExpression(const Expression & exp) {
-  if (exp.type == AtomType::Number || exp.type == AtomType::Symbol) {
-    // For atoms (numbers and symbols), return the atom itself
-    return exp;
+  // Lists are evaluated with an explicit stack of frames instead of recursion, so the depth of
+  // a program is limited by `depthLimit` rather than by the C++ stack
+  frames.clear();
+  values.clear();
+  activations.clear();
+  locals.clear();
+  names.clear();
+  if (isLambdaForm(exp)) {
+    values.push_back(makeProcedure(exp));
+  } else if (exp.type == AtomType::None) {
+    enterList(exp, false);
   } else {
-    // For expressions, recursively evaluate each child
-    Expression result;
-    for (const auto & child : exp.children) {
-      result.children.push_back(evaluateExpression(child));
+    values.push_back(exp);
+  }
+
+  while (!frames.empty()) {
+    Frame & frame = frames.back();
+    const ExpressionList & children = frame.list->children();
+    if (frame.next < frame.end) {
+      const Expression & child = frame.kind == NodeKind::Let && !frame.bound
+                                     ? children[1].children()[frame.next++].children()[1] // A binding's value
+                                     : children[frame.next++];
+      if (isLambdaForm(child)) {
+        // The body is only evaluated when the procedure is called
+        values.push_back(makeProcedure(child));
+      } else if (child.type == AtomType::None) {
+        bool tail = false;
+        if (inTailPosition(frame)) {
+          // The value of the list is the value of the form, so the list takes over the form's
+          // frame: a chain of tail positions runs in a single frame however long it is
+          tail = frame.tail;
+          frames.pop_back();
+        }
+        enterList(child, tail); // Invalidates `frame`
+      } else if (child.type != AtomType::Symbol ||
+                 (frame.next == 2 && children[0].type == AtomType::Symbol &&
+                  children[0].symbol.value == SYMBOL_DEFINE)) {
+        // Numbers and booleans evaluate to themselves. The name given to define is not
+        // evaluated, so an existing definition can be replaced.
+        values.push_back(child);
+      } else {
+        // Defined symbols evaluate to their value; other symbols name procedures and stay as they are
+        const Expression * bound = lookup(child.symbol);
+        values.push_back(bound != nullptr ? *bound : child);
+      }
+      continue;
     }
 
-    // Check for special forms and procedures and handle accordingly
+    if (frame.kind != NodeKind::Apply) {
+      if (continueSpecialForm(frame)) {
+        continue;
+      }
+      // The operand evaluated last is the value of the form, and the only value left on `values`
+      bool tail = frame.tail;
+      frames.pop_back();
+      if (tail) {
+        leaveProcedure();
+      }
+      continue;
+    }
 
-    if (!result.children.empty() && result.children[0].type == AtomType::Symbol) {
-      const std::string &op = result.children[0].symValue;
-      if (op == "define") {
-        // Handle define expression
-        if (result.children.size() != 3) {
-          throw InterpreterSemanticError("Error: define requires exactly two arguments");
-        }
+    // Every element has been evaluated: replace them with the value of the list. Each element
+    // is a temporary, so it is moved rather than copied.
+    size_t base = frame.base;
+    bool tail = frame.tail;
+    frames.pop_back();
+    if (values[base].type == AtomType::Procedure) {
+      callClosure(base, tail);
+      continue;
+    }
+    Expression value;
+    applyList(environment, values.data() + base, values.size() - base, value);
+    values.resize(base);
+    values.push_back(std::move(value));
+    if (tail) {
+      leaveProcedure();
+    }
+  }
 
-        // Assume the second child is the symbol to be defined and the third child is its value
-        const std::string &symbol = result.children[1].symValue;
-        Expression value = evaluateExpression(result.children[2]);
+  Expression result = std::move(values.back());
+  values.clear();
+  return result;
+}
 
-        // Update environment or store the defined symbol and its value
-        // TODO: Implement logic to store the symbol and its value
+void Interpreter::enterList(const Expression & list, bool tail) {
+  checkDepth(frames.size() + 1, depthLimit);
+  const ExpressionList & children = list.children();
+  NodeKind kind = NodeKind::Apply;
+  if (!children.empty() && children[0].type == AtomType::Symbol) {
+    switch (children[0].symbol.value) {
+      case SYMBOL_BEGIN: kind = NodeKind::Begin; break;
+      case SYMBOL_IF: kind = NodeKind::If; break;
+      case SYMBOL_AND: kind = NodeKind::And; break;
+      case SYMBOL_OR: kind = NodeKind::Or; break;
+      case SYMBOL_LET: kind = NodeKind::Let; break;
+      default: break;
+    }
+  }
 
-        // Return the defined value for demonstration purposes
-        return value;
-      } else if (op == "+") {
-        // Handle addition
-        if (result.children.size() < 2) {
-          throw InterpreterSemanticError("Error: Addition requires at least two arguments");
-        }
-        double sum = 0;
-        for (size_t i = 1; i < result.children.size(); ++i) {
-          if (result.children[i].type != AtomType::Number) {
-            throw InterpreterSemanticError("Error: Addition requires numeric arguments");
-          }
-          sum += result.children[i].numValue;
-        }
-        return Expression(sum);
-      } else if (op == "-") {
-        // Handle subtraction
-        if (result.children.size() < 2) {
-          throw InterpreterSemanticError("Error: Subtraction requires at least two arguments");
-        }
-        double diff = result.children[1].numValue;
-        for (size_t i = 2; i < result.children.size(); ++i) {
-          if (result.children[i].type != AtomType::Number) {
-            throw InterpreterSemanticError("Error: Subtraction requires numeric arguments");
-          }
-          diff -= result.children[i].numValue;
-        }
-        return Expression(diff);
-      } else if (op == "*") {
-        // Handle multiplication
-        if (result.children.size() < 2) {
-          throw InterpreterSemanticError("Error: Multiplication requires at least two arguments");
-        }
-        double product = 1;
-        for (size_t i = 1; i < result.children.size(); ++i) {
-          if (result.children[i].type != AtomType::Number) {
-            throw InterpreterSemanticError("Error: Multiplication requires numeric arguments");
-          }
-          product *= result.children[i].numValue;
-        }
-        return Expression(product);
-      } else if (op == "/") {
-        // Handle division
-        if (result.children.size() != 3) {
-          throw InterpreterSemanticError("Error: Division requires exactly two arguments");
-        }
-        double numerator, denominator;
-        if (result.children[1].type != AtomType::Number || result.children[2].type != AtomType::Number) {
-          throw InterpreterSemanticError("Error: Division requires numeric arguments");
-        }
-        numerator = result.children[1].numValue;
-        denominator = result.children[2].numValue;
-        if (denominator == 0) {
-          throw InterpreterSemanticError("Error: Division by zero");
-        }
-        return Expression(numerator / denominator);
+  if (kind == NodeKind::Apply) {
+    frames.push_back(Frame{&list, kind, 0, children.size(), values.size(), tail, false});
+  } else if (kind == NodeKind::Let) {
+    // The values of the bindings are evaluated before any variable is bound
+    checkArity(children[0].symbol, children.size() - 1);
+    frames.push_back(Frame{&list, kind, 0, children[1].children().size(), values.size(), tail, false});
+  } else {
+    // Special forms control the evaluation of their operands, starting with the first one only
+    checkArity(children[0].symbol, children.size() - 1);
+    frames.push_back(Frame{&list, kind, 1, 2, values.size(), tail, false});
+  }
+}
+
+const Expression * Interpreter::lookup(SymbolId symbol) const {
+  // The variables of the procedure call being run, innermost first, then its captured variables,
+  // come before the environment. Outside every procedure, the variables of `let` forms do.
+  size_t first = activations.empty() ? 0 : activations.back().base;
+  for (size_t i = locals.size(); i-- > first;) {
+    if (names[i] == symbol) {
+      return &locals[i];
+    }
+  }
+  if (!activations.empty()) {
+    const Closure & closure = *activations.back().procedure.closure;
+    const std::vector<SymbolId> & captures = closure.lambda->captures;
+    for (size_t i = 0; i < captures.size(); ++i) {
+      if (captures[i] == symbol) {
+        return &closure.captured[i];
       }
     }
-    // TODO: Implement special form and procedure handling
+  }
+  return environment.find(symbol);
+}
 
-    // For simplicity, assuming here that the expression itself is the result
-    return result;
+Expression Interpreter::makeProcedure(const Expression & form) {
+  // The form was compiled into the lambdas of the code it appears in, in the order of `forms`
+  const std::vector<const Expression *> * forms = &lambdaForms;
+  const std::vector<Lambda *> * compiled = &code.lambdas;
+  if (!activations.empty()) {
+    Lambda * lambda = activations.back().procedure.closure->lambda;
+    forms = &lambda->nested;
+    compiled = &lambda->code.lambdas;
   }
+  size_t index = 0;
+  while ((*forms)[index] != &form) {
+    ++index;
+  }
+  Lambda * lambda = (*compiled)[index];
+
+  // Analysis only lets a form capture variables of the procedures around it
+  std::vector<Expression> captured;
+  captured.reserve(lambda->captures.size());
+  for (SymbolId symbol : lambda->captures) {
+    captured.push_back(*lookup(symbol));
+  }
+  return makeClosure(lambda, captured.data(), captured.size());
 }
 
-bool Interpreter::parse(std::string& expression) noexcept {
-    try {
-        // Parse the input expression to get the AST
-        Expression ast = parseExpression(expression);
+void Interpreter::callClosure(size_t base, bool tail) {
+  // The procedure and its arguments are `values` from `base` on. A call in tail position
+  // finishes the call it belongs to first, so tail calls run in constant space.
+  Expression procedure = std::move(values[base]);
+  const Lambda & lambda = *procedure.closure->lambda;
+  size_t count = values.size() - base - 1;
+  checkArguments(lambda, count);
+  if (tail) {
+    leaveProcedure();
+  }
+  checkDepth(activations.size() + 1, depthLimit);
+  size_t first = locals.size();
+  const ExpressionList & parameters = lambda.form.children()[1].children();
+  for (size_t i = 0; i < count; ++i) {
+    locals.push_back(std::move(values[base + 1 + i]));
+    names.push_back(parameters[i].symbol);
+  }
+  values.resize(base);
+  activations.push_back(Activation{std::move(procedure), first});
+
+  // The body's value is the value of the call
+  const Expression & body = lambda.form.children()[2];
+  if (isLambdaForm(body)) {
+    values.push_back(makeProcedure(body));
+  } else if (body.type == AtomType::None) {
+    enterList(body, true);
+    return;
+  } else if (body.type == AtomType::Symbol) {
+    const Expression * bound = lookup(body.symbol);
+    values.push_back(bound != nullptr ? *bound : body);
+  } else {
+    values.push_back(body);
+  }
+  leaveProcedure();
+}
 
-        // TODO: Store the AST for later evaluation
-        // Here, just printing the AST for demonstration purposes
-        std::cout << " " << ast << std::endl;
+void Interpreter::leaveProcedure() {
+  locals.resize(activations.back().base);
+  names.resize(activations.back().base);
+  activations.pop_back();
+}
 
-        // Store the AST for later evaluation
-        // TODO: Implement AST storage logic
+bool Interpreter::inTailPosition(const Frame & frame) const {
+  // Called after `frame.next` has moved past the element about to be evaluated. Earlier operands
+  // of the form have been dropped from `values` by then, so its frame holds nothing else.
+  switch (frame.kind) {
+    case NodeKind::Begin: return frame.next == frame.list->children().size();
+    case NodeKind::If: return frame.end != 2; // A branch rather than the condition
+    // The body, but only where leaving the procedure unbinds the variables in the form's place
+    case NodeKind::Let: return frame.bound && frame.tail;
+    default: return false;
+  }
+}
 
+bool Interpreter::continueSpecialForm(Frame & frame) {
+  // Called once the operand before `frame.end` has been evaluated; returns false when the form
+  // is finished, leaving its value on `values`
+  if (frame.kind == NodeKind::Let) {
+    const ExpressionList & bindings = frame.list->children()[1].children();
+    if (frame.bound) {
+      // The body has been evaluated, so its variables go out of scope
+      locals.resize(locals.size() - bindings.size());
+      names.resize(names.size() - bindings.size());
+      return false;
+    }
+    // Every value has been evaluated: bind them, then evaluate the body
+    for (size_t i = 0; i < bindings.size(); ++i) {
+      locals.push_back(std::move(values[frame.base + i]));
+      names.push_back(bindings[i].children()[0].symbol);
+    }
+    values.resize(frame.base);
+    frame.bound = true;
+    frame.next = 2;
+    frame.end = 3;
+    return true;
+  }
+
+  Expression & operand = values.back();
+  if (frame.kind == NodeKind::Begin) {
+    if (frame.end == frame.list->children().size()) {
+      return false; // The last operand has been evaluated
+    }
+    // Every operand but the last is only evaluated for its effect
+    values.pop_back();
+    ++frame.end;
+    return true;
+  }
+  if (frame.kind == NodeKind::If) {
+    if (frame.end != 2) {
+      return false; // The selected branch has been evaluated
+    }
+    if (operand.type != AtomType::Boolean) {
+      throw InterpreterSemanticError("Error: if requires a boolean condition");
+    }
+    // Evaluate only the branch the condition selects
+    frame.next = operand.boolValue ? 2 : 3;
+    frame.end = frame.next + 1;
+    values.pop_back();
+    return true;
+  }
+
+  bool isAnd = frame.kind == NodeKind::And;
+  if (operand.type != AtomType::Boolean) {
+    throw InterpreterSemanticError(std::string("Error: ") + (isAnd ? "and" : "or") + " requires boolean arguments");
+  }
+  if (operand.boolValue != isAnd || frame.end == frame.list->children().size()) {
+    return false; // This operand decides the result, or is the last one
+  }
+  values.pop_back();
+  ++frame.end;
+  return true;
+}
+
+bool Interpreter::parse(std::string& expression) noexcept {
+    try {
+        // Parse the input expression and store the AST for later evaluation
+        loadProgram(expression.data(), expression.size());
         return true; // Return true if parsing is successful
     } catch (...) {
         return false; // Return false on failure
     }
 }
 
+bool Interpreter::parseFile(const std::string& path) noexcept {
+    try {
+        // Tokenize straight out of the read-only mapping instead of reading the file into a string
+        MappedFile file(path);
+        loadProgram(file.data(), file.size());
+        return true;
+    } catch (...) {
+        return false; // Return false on failure
+    }
+}
+
+bool Interpreter::parse(std::istream& expression) noexcept {
+    try {
+        // Read the program one form at a time; it must consist of exactly one form
+        FormReader reader(expression);
+        std::string form;
+        if (!reader.next(form)) {
+            return false;
+        }
+        std::string extra;
+        if (reader.next(extra)) {
+            return false;
+        }
+        return parse(form);
+    } catch (...) {
+        return false; // Return false on failure
+    }
+}
+
 
 void Interpreter::runREPL() {
   std::string input;
   while (true) {
     std::cout << "slisp> ";
-    getline(std::cin, input);
+    if (!getline(std::cin, input)) {
+      break; // Stop at end of input
+    }
 
     if (input.empty()) {
       continue; // Ignore empty lines
@@ -176,13 +488,39 @@ void Interpreter::runREPL() {
     }
 
     try {
-      // TODO: Evaluate the stored AST
-      // Update the environment accordingly
-      // Print the result
-      Expression result; // Replace with actual evaluation result
-      std::cout << result << std::endl; // Assuming Expression has an appropriate ostream operator
+      // Evaluate the stored AST and print the result
+      Expression result = eval();
+      std::cout << result << std::endl;
+    } catch (const InterpreterSemanticError & e) {
+      std::cerr << e.what() << std::endl;
+    }
+  }
+}
+
+void Interpreter::runStream(std::istream& input) {
+  // Evaluate each top-level form as soon as it has been read, so memory stays
+  // proportional to the largest form rather than to the whole input
+  FormReader reader(input);
+  std::string form;
+  while (true) {
+    try {
+      if (!reader.next(form)) {
+        break;
+      }
+    } catch (const InterpreterSemanticError & e) {
+      std::cerr << e.what() << std::endl;
+      break;
+    }
+
+    if (!parse(form)) {
+      std::cerr << "Error: Failed to parse input." << std::endl;
+      continue;
+    }
+
+    try {
+      std::cout << eval() << std::endl;
     } catch (const InterpreterSemanticError & e) {
-      std::cerr << "Error: " << e.what() << std::endl;
+      std::cerr << e.what() << std::endl;
     }
   }
 }
@@ -5,22 +5,90 @@
 #include <sstream>
 #include "environment.hpp"
 #include "expression.hpp"
+#include "arena.hpp"
+#include "flat_ast.hpp"
+#include "analysis.hpp"
+#include "optimizer.hpp"
+#include "type_inference.hpp"
+#include "bytecode.hpp"
+#include "vm.hpp"
+#include "procedure.hpp"
+#include "tokenize.hpp"
 #include <stdexcept>
+#include <vector>
 
-
+// Selects which evaluator eval() runs: the tree walker over `Expression`, kept as the reference
+// for differential testing, or the bytecode virtual machine (the default).
+enum class EvaluationEngine { Tree, Bytecode };
 
 class Interpreter {
 public:
     Interpreter();
     bool parse(std::string& expression) noexcept;
+    bool parse(std::istream& expression) noexcept;
+    bool parseFile(const std::string& path) noexcept;
     Expression eval();
+    void setEngine(EvaluationEngine engine);
+    void setDepthLimit(size_t limit); // Deeper programs fail to evaluate; see DEFAULT_DEPTH_LIMIT
+    void setJit(bool enabled); // Run hot numeric code as machine code in JIT builds; see jit.hpp
+    void translate(const std::string& function, std::ostream& source); // C++ for the program; see aot.hpp
     void runREPL();
+    void runStream(std::istream& input);
 
 private:
     Environment environment;
+    void releaseProgram();
+    void loadProgram(const char* data, size_t size);
     Expression parseExpression(std::string& expression);
+    Expression parseExpression(const char* data, size_t size);
     Expression evaluateExpression(const Expression& exp);
+    void enterList(const Expression& list, bool tail);
+
+    // A list being evaluated by the tree walker. Its elements up to `end` are evaluated in order
+    // onto `values`; for `begin`, `if`, `and` and `or` (`kind`), `end` then moves to the next
+    // operand needed. A `let` evaluates the values of its bindings first, `next` and `end`
+    // counting bindings, then binds them and evaluates its body.
+    struct Frame {
+        const Expression* list;
+        NodeKind kind;  // Begin, If, And, Or, Let, or Apply for every other list
+        size_t next;    // Index of the next element to evaluate
+        size_t end;     // Index past the last element to evaluate before deciding what to do next
+        size_t base;    // Index in `values` of the first evaluated element
+        bool tail;      // Whether its value is the value of the innermost procedure call
+        bool bound;     // For let, whether its variables have been bound
+    };
+    bool continueSpecialForm(Frame& frame);
+    bool inTailPosition(const Frame& frame) const;
+
+    // A procedure call being evaluated by the tree walker, whose arguments, followed by the
+    // variables of the `let` forms being evaluated in its body, are `locals` from `base` on.
+    struct Activation {
+        Expression procedure;
+        size_t base;
+    };
+    const Expression* lookup(SymbolId symbol) const;
+    Expression makeProcedure(const Expression& form);
+    void callClosure(size_t base, bool tail);
+    void leaveProcedure();
+    Arena arena; // Owns every list node of the current program; reset before the next parse
     Expression ast;
+    FlatAst program;                  // Flat copy of `ast` that is analyzed and compiled
+    std::vector<NodeInfo> nodes;      // Analysis of each node of `program`, filled by the first eval()
+    std::vector<LambdaInfo> lambdas;  // Analysis of each `lambda` form of `program`
+    std::vector<Expression> folded;   // Constants computed by the optimizer for `nodes`
+    std::vector<StaticType> types;    // Type of each node of `program`, proven by inferTypes
+    Bytecode code;                    // `program` compiled by the first eval()
+    bool analyzed;
+    VirtualMachine machine;
+    EvaluationEngine engine;
+    size_t depthLimit;
+    std::vector<Frame> frames;        // The tree walker's stack of open lists, innermost last
+    std::vector<Expression> values;   // Evaluated elements of the open lists
+    std::vector<Activation> activations; // The tree walker's procedure calls, innermost last
+    std::vector<Expression> locals;   // Arguments of the procedure calls and variables of `let` forms
+    std::vector<SymbolId> names;      // Symbol of each of `locals`
+    std::vector<const Expression*> lambdaForms; // `lambda` forms of `ast` compiled into `code.lambdas`
+    std::vector<Token> tokens; // Reused by every parse so streaming does not reallocate per form
 
     // Add additional private methods if needed
 };
@@ -0,0 +1,461 @@
+#include "jit.hpp"       // Include header file for NativeCode class
+
+#ifdef SLISP_JIT
+#include "bytecode.hpp"  // Include header file for Instruction
+#include <cmath>         // Include cmath for pow and log10
+#include <cstring>       // Include cstring for memcpy
+#include <sys/mman.h>    // Include sys/mman for mmap, mprotect and munmap
+#include <unistd.h>      // Include unistd for sysconf
+
+namespace {
+
+  /**
+   * Size of the executable chunks regions are placed in; larger regions get a chunk of their own.
+   */
+  const size_t CHUNK_SIZE = 64 * 1024;
+
+  /**
+   * Registers xmm0 up to xmm13 hold the number stack; deeper regions are not compiled.
+   * xmm14 and xmm15 are scratch registers.
+   */
+  const uint32_t REGISTER_SLOTS = 14;
+  const uint8_t SCRATCH = 15;
+
+  /**
+   * General purpose registers, numbered as in their encoding.
+   */
+  enum Register : uint8_t { RBX = 3, RSP = 4, RBP = 5 };
+
+  /**
+   * Bytes below the saved registers: a spill slot for each register slot, padded so that calls
+   * are made with the stack aligned to 16 bytes.
+   */
+  const int32_t FRAME_SIZE = 8 * REGISTER_SLOTS + 8;
+
+  double callPower(double a, double b) {
+    return b == 2 ? a * a : std::pow(a, b);
+  }
+
+  double callLog10(double a) {
+    return std::log10(a);
+  }
+
+  /**
+   * Emits the x86-64 instructions the JIT needs, in the System V calling convention.
+   *
+   * The generated function keeps `inputs` in rbx and `result` in rbp, both callee-saved, and
+   * the number stack in xmm registers, which are spilled to the frame around calls.
+   */
+  class Assembler {
+  public:
+    std::vector<uint8_t> bytes;
+
+    void prologue() {
+      byte(0x53);                     // push rbx
+      byte(0x55);                     // push rbp
+      bytes.insert(bytes.end(), {0x48, 0x81, 0xEC}); // sub rsp, FRAME_SIZE
+      int32(FRAME_SIZE);
+      bytes.insert(bytes.end(), {0x48, 0x89, 0xFB}); // mov rbx, rdi
+      bytes.insert(bytes.end(), {0x48, 0x89, 0xF5}); // mov rbp, rsi
+    }
+
+    void epilogue() {
+      bytes.insert(bytes.end(), {0x48, 0x81, 0xC4}); // add rsp, FRAME_SIZE
+      int32(FRAME_SIZE);
+      byte(0x5D);                     // pop rbp
+      byte(0x5B);                     // pop rbx
+      byte(0xC3);                     // ret
+    }
+
+    /**
+     * Scalar double operation `opcode` (0x58 add, 0x59 mul, 0x5C sub, 0x5E div) on two registers.
+     */
+    void scalar(uint8_t opcode, uint8_t destination, uint8_t source) {
+      byte(0xF2);
+      registers(opcode, destination, source);
+    }
+
+    /**
+     * Packed double operation `opcode` (0x28 movapd, 0x2E ucomisd, 0x57 xorpd) on two registers.
+     */
+    void packed(uint8_t opcode, uint8_t destination, uint8_t source) {
+      byte(0x66);
+      registers(opcode, destination, source);
+    }
+
+    void move(uint8_t destination, uint8_t source) {
+      if (destination != source) {
+        packed(0x28, destination, source);
+      }
+    }
+
+    /**
+     * movsd between xmm `reg` and `[base + displacement]`, loading if `load` is set.
+     */
+    void memory(bool load, uint8_t reg, Register base, int32_t displacement) {
+      byte(0xF2);
+      if (reg >= 8) {
+        byte(0x44);
+      }
+      byte(0x0F);
+      byte(load ? 0x10 : 0x11);
+      byte(static_cast<uint8_t>(0x80 | (reg & 7) << 3 | base));
+      if (base == RSP) {
+        byte(0x24);
+      }
+      int32(displacement);
+    }
+
+    /**
+     * Loads the bits of `value` into xmm `reg`, through rax.
+     */
+    void constant(uint8_t reg, double value) {
+      uint64_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      bytes.insert(bytes.end(), {0x48, 0xB8}); // mov rax, imm64
+      for (int i = 0; i < 8; ++i) {
+        byte(static_cast<uint8_t>(bits >> (8 * i)));
+      }
+      byte(0x66);
+      byte(reg >= 8 ? 0x4C : 0x48);   // movq xmm, rax
+      byte(0x0F);
+      byte(0x6E);
+      byte(static_cast<uint8_t>(0xC0 | (reg & 7) << 3));
+    }
+
+    void call(const void* function) {
+      uint64_t address = reinterpret_cast<uint64_t>(function);
+      bytes.insert(bytes.end(), {0x48, 0xB8}); // mov rax, imm64
+      for (int i = 0; i < 8; ++i) {
+        byte(static_cast<uint8_t>(address >> (8 * i)));
+      }
+      bytes.insert(bytes.end(), {0xFF, 0xD0}); // call rax
+    }
+
+    void returnValue(int32_t value) {
+      byte(0xB8);                     // mov eax, imm32
+      int32(value);
+    }
+
+    /**
+     * Sets eax to the condition `code` (0x93 ae, 0x94 e, 0x97 a) of the last comparison.
+     * For equality the parity flag must also be clear, since unordered operands set ZF.
+     */
+    void setCondition(uint8_t code) {
+      bytes.insert(bytes.end(), {0x0F, code, 0xC0});       // setcc al
+      if (code == 0x94) {
+        bytes.insert(bytes.end(), {0x0F, 0x9B, 0xC1});     // setnp cl
+        bytes.insert(bytes.end(), {0x20, 0xC8});           // and al, cl
+      }
+      bytes.insert(bytes.end(), {0x0F, 0xB6, 0xC0});       // movzx eax, al
+    }
+
+    /**
+     * Emits a jump (`code` 0 for jmp, or a jcc such as 0x85 jne and 0x8A jp) whose target is set
+     * later by `bind`, and returns it.
+     */
+    size_t jump(uint8_t code) {
+      if (code == 0) {
+        byte(0xE9);
+      } else {
+        byte(0x0F);
+        byte(code);
+      }
+      int32(0);
+      return bytes.size();
+    }
+
+    /**
+     * Points the jump returned by `jump` at the current position.
+     */
+    void bind(size_t jump) {
+      int32_t offset = static_cast<int32_t>(bytes.size() - jump);
+      std::memcpy(bytes.data() + jump - 4, &offset, sizeof(offset));
+    }
+
+  private:
+    void byte(uint8_t value) {
+      bytes.push_back(value);
+    }
+
+    void int32(int32_t value) {
+      for (int i = 0; i < 4; ++i) {
+        byte(static_cast<uint8_t>(static_cast<uint32_t>(value) >> (8 * i)));
+      }
+    }
+
+    void registers(uint8_t opcode, uint8_t destination, uint8_t source) {
+      if (destination >= 8 || source >= 8) {
+        byte(static_cast<uint8_t>(0x40 | (destination >= 8) << 2 | (source >= 8)));
+      }
+      byte(0x0F);
+      byte(opcode);
+      byte(static_cast<uint8_t>(0xC0 | (destination & 7) << 3 | (source & 7)));
+    }
+  };
+
+  /**
+   * Translates a numeric region, tracking the depth of the number stack so that slot `i` is
+   * always register xmm`i`.
+   */
+  class RegionCompiler {
+  public:
+    RegionCompiler(const std::vector<double>& numbers, std::vector<SymbolId>& inputs, uint32_t firstInput)
+      : numbers(numbers), inputs(inputs), firstInput(firstInput), depth(0) {}
+
+    /**
+     * Emits the whole function, returning false if the region cannot be compiled.
+     */
+    bool compile(const Instruction* first, const Instruction* last, bool& comparison) {
+      code.prologue();
+      for (const Instruction* ip = first; ip != last; ++ip) {
+        if (!translate(*ip, comparison)) {
+          return false;
+        }
+      }
+      for (size_t exit : exits) {
+        code.bind(exit);
+      }
+      code.epilogue();
+      return true;
+    }
+
+    std::vector<uint8_t>& bytes() { return code.bytes; }
+
+  private:
+    bool translate(const Instruction& instruction, bool& comparison) {
+      switch (instruction.opcode) {
+        case Opcode::PushNumber:
+          if (depth == REGISTER_SLOTS) {
+            return false;
+          }
+          code.constant(static_cast<uint8_t>(depth++), numbers[instruction.operand]);
+          return true;
+        case Opcode::LoadNumber:
+        case Opcode::LoadProvenNumber:
+          if (depth == REGISTER_SLOTS) {
+            return false;
+          }
+          code.memory(true, static_cast<uint8_t>(depth++), RBX, 8 * input(SymbolId{instruction.operand}));
+          return true;
+        case Opcode::AddNumbers: {
+          // Summed from zero, like the builtin, so that (+ -0 -0) is 0
+          uint8_t base = static_cast<uint8_t>(depth - instruction.count);
+          code.packed(0x57, SCRATCH, SCRATCH);
+          for (uint8_t slot = base; slot < depth; ++slot) {
+            code.scalar(0x58, SCRATCH, slot);
+          }
+          code.move(base, SCRATCH);
+          depth = base + 1;
+          return true;
+        }
+        case Opcode::MultiplyNumbers: {
+          // Multiplying by the builtin's initial 1 never changes the product, so it is left out
+          uint8_t base = static_cast<uint8_t>(depth - instruction.count);
+          for (uint8_t slot = base + 1; slot < depth; ++slot) {
+            code.scalar(0x59, base, slot);
+          }
+          depth = base + 1;
+          return true;
+        }
+        case Opcode::SubtractNumbers:
+          if (instruction.count == 1) {
+            code.constant(SCRATCH, -0.0);
+            code.packed(0x57, static_cast<uint8_t>(depth - 1), SCRATCH);
+          } else {
+            code.scalar(0x5C, static_cast<uint8_t>(depth - 2), static_cast<uint8_t>(depth - 1));
+            --depth;
+          }
+          return true;
+        case Opcode::DivideNumbers: {
+          uint8_t divisor = static_cast<uint8_t>(depth - 1);
+          code.packed(0x57, SCRATCH, SCRATCH);
+          code.packed(0x2E, divisor, SCRATCH);
+          size_t unordered = code.jump(0x8A); // NaN is not zero
+          size_t nonzero = code.jump(0x85);
+          code.returnValue(-1);
+          exits.push_back(code.jump(0));
+          code.bind(unordered);
+          code.bind(nonzero);
+          code.scalar(0x5E, static_cast<uint8_t>(depth - 2), divisor);
+          --depth;
+          return true;
+        }
+        case Opcode::PowerNumbers:
+          callHelper(reinterpret_cast<const void*>(&callPower), 2);
+          return true;
+        case Opcode::Log10Number:
+          callHelper(reinterpret_cast<const void*>(&callLog10), 1);
+          return true;
+        case Opcode::LessNumbers:
+          return compare(1, 0, 0x97, comparison);
+        case Opcode::LessEqualNumbers:
+          return compare(1, 0, 0x93, comparison);
+        case Opcode::GreaterNumbers:
+          return compare(0, 1, 0x97, comparison);
+        case Opcode::GreaterEqualNumbers:
+          return compare(0, 1, 0x93, comparison);
+        case Opcode::EqualNumbers:
+          return compare(0, 1, 0x94, comparison);
+        case Opcode::Box:
+          code.memory(false, 0, RBP, 0);
+          code.returnValue(0);
+          comparison = false;
+          return true;
+        default:
+          // Unbox runs ordinary bytecode inside the region, which only the interpreter can do
+          return false;
+      }
+    }
+
+    /**
+     * Returns the position of `symbol` among the region's inputs, adding it if needed.
+     */
+    int32_t input(SymbolId symbol) {
+      for (uint32_t i = firstInput; i < inputs.size(); ++i) {
+        if (inputs[i] == symbol) {
+          return static_cast<int32_t>(i - firstInput);
+        }
+      }
+      inputs.push_back(symbol);
+      return static_cast<int32_t>(inputs.size() - 1 - firstInput);
+    }
+
+    /**
+     * Calls `helper` on the top `arguments` slots, replacing them with its result. The slots
+     * below them are spilled to the frame, since calls may change every xmm register.
+     */
+    void callHelper(const void* helper, uint32_t arguments) {
+      uint8_t base = static_cast<uint8_t>(depth - arguments);
+      for (uint8_t slot = 0; slot < base; ++slot) {
+        code.memory(false, slot, RSP, 8 * slot);
+      }
+      for (uint8_t argument = 0; argument < arguments; ++argument) {
+        code.move(argument, static_cast<uint8_t>(base + argument));
+      }
+      code.call(helper);
+      code.move(base, 0);
+      for (uint8_t slot = 0; slot < base; ++slot) {
+        code.memory(true, slot, RSP, 8 * slot);
+      }
+      depth = base + 1;
+    }
+
+    /**
+     * Compares the top two slots, `a` below `b`, with ucomisd of the slot `left` positions above
+     * `a` against the slot `right` positions above it, and returns condition `condition`.
+     */
+    bool compare(uint8_t left, uint8_t right, uint8_t condition, bool& comparison) {
+      uint8_t a = static_cast<uint8_t>(depth - 2);
+      code.packed(0x2E, static_cast<uint8_t>(a + left), static_cast<uint8_t>(a + right));
+      code.setCondition(condition);
+      comparison = true;
+      return true;
+    }
+
+    Assembler code;
+    const std::vector<double>& numbers;
+    std::vector<SymbolId>& inputs;
+    uint32_t firstInput;
+    uint32_t depth;            // Slots on the number stack
+    std::vector<size_t> exits; // Jumps to the epilogue
+  };
+}
+
+/**
+ * Destructor for the `NativeCode` class. Unmaps the code pages.
+ */
+NativeCode::~NativeCode() {
+  for (const Chunk& chunk : chunks) {
+    ::munmap(chunk.base, chunk.size);
+  }
+}
+
+/**
+ * Compiles a numeric region into machine code, which is then only reachable through `region`.
+ */
+int32_t NativeCode::compile(const Instruction* first, const Instruction* last, const std::vector<double>& numbers) {
+  uint32_t firstInput = static_cast<uint32_t>(inputs.size());
+  RegionCompiler compiler(numbers, inputs, firstInput);
+  bool comparison = false;
+  void* function = nullptr;
+  if (compiler.compile(first, last, comparison)) {
+    function = place(compiler.bytes());
+  }
+  if (function == nullptr) {
+    inputs.resize(firstInput);
+    return -1;
+  }
+  regions.push_back(NativeRegion{reinterpret_cast<NativeFunction>(function), firstInput,
+                                 static_cast<uint32_t>(inputs.size() - firstInput), comparison});
+  return static_cast<int32_t>(regions.size() - 1);
+}
+
+/**
+ * Removes every compiled region, keeping the code pages for reuse.
+ */
+void NativeCode::clear() {
+  regions.clear();
+  inputs.clear();
+  for (Chunk& chunk : chunks) {
+    chunk.used = 0;
+  }
+}
+
+/**
+ * Copies machine code into the first chunk with room for it, mapping a new chunk if there is
+ * none. The chunk is made writable only while the code is copied in, and is discarded if it
+ * cannot be made executable again.
+ */
+void* NativeCode::place(const std::vector<uint8_t>& bytes) {
+  size_t size = (bytes.size() + 15) & ~static_cast<size_t>(15);
+  Chunk* target = nullptr;
+  for (Chunk& chunk : chunks) {
+    if (chunk.size - chunk.used >= size) {
+      target = &chunk;
+      break;
+    }
+  }
+  if (target == nullptr) {
+    size_t chunkSize = size > CHUNK_SIZE ? (size + CHUNK_SIZE - 1) / CHUNK_SIZE * CHUNK_SIZE : CHUNK_SIZE;
+    void* address = ::mmap(nullptr, chunkSize, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (address == MAP_FAILED) {
+      return nullptr;
+    }
+    chunks.push_back(Chunk{static_cast<uint8_t*>(address), chunkSize, 0});
+    target = &chunks.back();
+  }
+
+  // Only the pages the code lands on change protection
+  uint8_t* start = target->base + target->used;
+  uintptr_t page = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+  uint8_t* first = reinterpret_cast<uint8_t*>(reinterpret_cast<uintptr_t>(start) & ~(page - 1));
+  size_t length = static_cast<size_t>(start + size - first);
+  if (::mprotect(first, length, PROT_READ | PROT_WRITE) != 0) {
+    return nullptr;
+  }
+  std::memcpy(start, bytes.data(), bytes.size());
+  if (::mprotect(first, length, PROT_READ | PROT_EXEC) != 0) {
+    // The pages must not stay writable, and the code already on them cannot run any more
+    discard(*target);
+    return nullptr;
+  }
+  target->used += size;
+  return start;
+}
+
+/**
+ * Unmaps `chunk` and removes it, leaving the regions placed in it without machine code.
+ */
+void NativeCode::discard(Chunk& chunk) {
+  for (NativeRegion& region : regions) {
+    uint8_t* function = reinterpret_cast<uint8_t*>(region.function);
+    if (function >= chunk.base && function < chunk.base + chunk.size) {
+      region.function = nullptr;
+    }
+  }
+  ::munmap(chunk.base, chunk.size);
+  chunks.erase(chunks.begin() + (&chunk - chunks.data()));
+}
+
+#endif // SLISP_JIT
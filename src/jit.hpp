@@ -0,0 +1,103 @@
+#ifndef JIT_HPP // Prevent multiple inclusions
+#define JIT_HPP   // Define a unique identifier for the header file
+
+#include <cstddef>          // Include cstddef for size_t
+#include <cstdint>          // Include cstdint for the region indices
+#include <vector>           // Include vector for the code chunks and inputs
+#include "symbol_table.hpp" // Include header file for SymbolId
+
+/**
+ * This header file defines the optional JIT tier, which translates hot numeric regions of the
+ * bytecode (see `compileProgram`) into x86-64 machine code.
+ *
+ * It is only built when CMake is configured with `-DSLISP_JIT=ON` on an x86-64 Unix system,
+ * which defines `SLISP_JIT`. The machine code is produced by a small emitter of its own and
+ * placed in pages mapped with `mmap`, which are only writable while code is being added.
+ */
+#ifdef SLISP_JIT
+
+struct Instruction;
+
+/**
+ * Number of times a numeric region is entered before it is compiled to machine code. Compiling
+ * a region costs about as much as interpreting it a hundred times, mostly in changing the
+ * protection of its code page, and most programs are only evaluated once.
+ */
+const uint32_t JIT_THRESHOLD = 100;
+
+/**
+ * Machine code for a numeric region. `inputs` holds the values of the variables the region
+ * reads, in the order of `NativeRegion::firstInput`; the result is stored in `result`.
+ *
+ * Returns -1 on a division by zero. Otherwise a region ending in a comparison returns its
+ * result (0 or 1) and leaves `result` alone, and any other region returns 0.
+ */
+typedef int (*NativeFunction)(const double* inputs, double* result);
+
+/**
+ * A compiled numeric region: its machine code, and the variables to pass it, which are
+ * `NativeCode::input(firstInput)` onwards.
+ */
+struct NativeRegion {
+  NativeFunction function; // Null once its code has been discarded, so the region is interpreted
+  uint32_t firstInput;
+  uint32_t inputCount;
+  bool comparison; // Whether the region ends in a comparison rather than a number
+};
+
+/**
+ * The machine code compiled for one bytecode program, kept with the `Bytecode` it belongs to.
+ */
+class NativeCode {
+public:
+  NativeCode() = default;
+
+  /**
+   * Destructor for the `NativeCode` class. Unmaps the code pages.
+   */
+  ~NativeCode();
+
+  NativeCode(const NativeCode&) = delete;
+  NativeCode& operator=(const NativeCode&) = delete;
+
+  /**
+   * Compiles the numeric region made of the instructions from `first` up to `last`, whose
+   * `PushNumber` operands index `numbers`. Returns the index of the result for `region`, or -1
+   * if the region uses something the JIT does not handle, so it stays interpreted.
+   */
+  int32_t compile(const Instruction* first, const Instruction* last, const std::vector<double>& numbers);
+
+  const NativeRegion& region(int32_t index) const { return regions[index]; }
+  SymbolId input(uint32_t index) const { return inputs[index]; }
+
+  /**
+   * Removes every compiled region, keeping the code pages for reuse.
+   */
+  void clear();
+
+private:
+  /**
+   * Copies `bytes` into executable memory and returns where they start, or a null pointer if
+   * no memory could be mapped or its protection could not be changed.
+   */
+  void* place(const std::vector<uint8_t>& bytes);
+
+  struct Chunk {
+    uint8_t* base;
+    size_t size;
+    size_t used;
+  };
+
+  /**
+   * Unmaps `chunk`, leaving the regions placed in it to be interpreted.
+   */
+  void discard(Chunk& chunk);
+
+  std::vector<Chunk> chunks;
+  std::vector<NativeRegion> regions;
+  std::vector<SymbolId> inputs;
+};
+
+#endif // SLISP_JIT
+
+#endif // JIT_HPP // Guard against multiple inclusions
@@ -1,8 +1,28 @@
 // src/main.cpp
 #include "interpreter.hpp"
+#include <string>
 
-int main() {
+int main(int argc, char* argv[]) {
     Interpreter interpreter;
+    if (argc > 1 && std::string(argv[1]) == "-") {
+        // Evaluate forms piped through stdin one at a time
+        interpreter.runStream(std::cin);
+        return 0;
+    }
+    if (argc > 1) {
+        // Run a script file, which is mapped into memory rather than read
+        if (!interpreter.parseFile(argv[1])) {
+            std::cerr << "Error: Failed to parse " << argv[1] << std::endl;
+            return 1;
+        }
+        try {
+            std::cout << interpreter.eval() << std::endl;
+        } catch (const InterpreterSemanticError & e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
     interpreter.runREPL();
     return 0;
 }
@@ -0,0 +1,80 @@
+#include "mapped_file.hpp" // Include header file for MappedFile class
+#include <stdexcept>       // Include standard exception library
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SLISP_HAVE_MMAP 1
+#include <fcntl.h>         // Include fcntl for open
+#include <sys/mman.h>      // Include sys/mman for mmap, madvise and munmap
+#include <sys/stat.h>      // Include sys/stat for fstat
+#include <unistd.h>        // Include unistd for close
+#else
+#include <fstream>         // Include fstream for the read fallback
+#include <iterator>        // Include iterator for istreambuf_iterator
+#endif
+
+/**
+ * Constructor for the `MappedFile` class.
+ *
+ * The file descriptor is closed as soon as the mapping exists; the mapping keeps the file
+ * contents reachable on its own. Empty files are not mapped, since `mmap` rejects a zero length.
+ */
+MappedFile::MappedFile(const std::string& path) : bytes(""), length(0), mapped(false) {
+#ifdef SLISP_HAVE_MMAP
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Error: cannot open " + path);
+  }
+
+  struct stat status;
+  if (::fstat(fd, &status) != 0) {
+    ::close(fd);
+    throw std::runtime_error("Error: cannot stat " + path);
+  }
+
+  if (status.st_size > 0) {
+    void* address = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (address == MAP_FAILED) {
+      ::close(fd);
+      throw std::runtime_error("Error: cannot map " + path);
+    }
+    ::madvise(address, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+    bytes = static_cast<const char*>(address);
+    length = static_cast<size_t>(status.st_size);
+    mapped = true;
+  }
+  ::close(fd);
+#else
+  std::ifstream input(path, std::ios::binary);
+  if (!input) {
+    throw std::runtime_error("Error: cannot open " + path);
+  }
+  fallback.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+  bytes = fallback.data();
+  length = fallback.size();
+#endif
+}
+
+/**
+ * Destructor for the `MappedFile` class. Unmaps the file.
+ */
+MappedFile::~MappedFile() {
+#ifdef SLISP_HAVE_MMAP
+  if (mapped) {
+    ::munmap(const_cast<char*>(bytes), length);
+  }
+#endif
+}
+
+/**
+ * Returns a pointer to the first byte of the file. The bytes are not null-terminated.
+ */
+const char* MappedFile::data() const {
+  return bytes;
+}
+
+/**
+ * Returns the size of the file in bytes.
+ */
+size_t MappedFile::size() const {
+  return length;
+}
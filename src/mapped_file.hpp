@@ -0,0 +1,48 @@
+#ifndef MAPPED_FILE_HPP // Prevent multiple inclusions
+#define MAPPED_FILE_HPP   // Define a unique identifier for the header file
+
+#include <cstddef>    // Include cstddef for size_t
+#include <string>     // Include string library for the file path
+#include <vector>     // Include vector library for the read fallback
+
+/**
+ * This header file defines the `MappedFile` class, which gives read-only access to the contents
+ * of a script file without copying them into a string.
+ */
+class MappedFile {
+public:
+  /**
+   * Constructor for the `MappedFile` class.
+   *
+   * This constructor maps the file at `path` read-only and advises the kernel that it will be
+   * read sequentially. On platforms without `mmap` the file is read into memory instead.
+   * Throws a `std::runtime_error` if the file cannot be opened or mapped.
+   */
+  explicit MappedFile(const std::string& path);
+
+  /**
+   * Destructor for the `MappedFile` class. Unmaps the file.
+   */
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * Returns a pointer to the first byte of the file. The bytes are not null-terminated.
+   */
+  const char* data() const;
+
+  /**
+   * Returns the size of the file in bytes.
+   */
+  size_t size() const;
+
+private:
+  const char* bytes;
+  size_t length;
+  bool mapped;
+  std::vector<char> fallback;
+};
+
+#endif // MAPPED_FILE_HPP // Guard against multiple inclusions
@@ -0,0 +1,229 @@
+#include "optimizer.hpp" // Include header file for the optimization pass
+#include "interpreter_semantic_error.hpp" // Include header file for InterpreterSemanticError class
+#include <utility>       // Include utility for std::move
+
+namespace {
+
+  /**
+   * Rewrites the nodes of one program. Nodes are visited in reverse storage order, so the
+   * operands of a list have been optimized by the time the list itself is.
+   */
+  class Optimizer {
+  public:
+    Optimizer(const FlatAst& program, const Environment& environment, std::vector<NodeInfo>& nodes,
+              std::vector<Expression>& constants)
+      : program(program), environment(environment), nodes(nodes), constants(constants) {}
+
+    void optimize(uint32_t node) {
+      uint32_t first = node + 1;
+      switch (nodes[node].kind) {
+        case NodeKind::Variable: {
+          SymbolId symbol = program.symbol(node);
+          const Expression* value = environment.find(symbol);
+          if (isPredefinedSymbol(symbol) && value != nullptr) {
+            makeConstant(node, Expression(*value));
+          }
+          break;
+        }
+        case NodeKind::Begin: {
+          // Constant operands have no effect, so only the last one matters if all others are constant
+          uint32_t child = program.ends[first];
+          for (; program.ends[child] != program.ends[node]; child = program.ends[child]) {
+            if (!isConstant(child)) {
+              return;
+            }
+          }
+          makeAlias(node, child);
+          break;
+        }
+        case NodeKind::If: {
+          uint32_t condition = program.ends[first];
+          uint32_t consequent = program.ends[condition];
+          if (isConstant(condition)) {
+            Expression value = constantValue(condition);
+            if (value.type == AtomType::Boolean) {
+              makeAlias(node, value.boolValue ? consequent : program.ends[consequent]);
+            }
+          }
+          break;
+        }
+        case NodeKind::And:
+        case NodeKind::Or: {
+          bool isAnd = nodes[node].kind == NodeKind::And;
+          for (uint32_t child = program.ends[first]; child < program.ends[node]; child = program.ends[child]) {
+            if (!isConstant(child)) {
+              return;
+            }
+            Expression value = constantValue(child);
+            if (value.type != AtomType::Boolean) {
+              return; // Left for evaluation to report
+            }
+            if (value.boolValue != isAnd || program.ends[child] == program.ends[node]) {
+              makeAlias(node, child);
+              return;
+            }
+          }
+          break;
+        }
+        case NodeKind::BuiltinCall:
+          if (!fold(node)) {
+            simplify(node);
+          }
+          break;
+        default:
+          break;
+      }
+    }
+
+  private:
+    /**
+     * Computes a builtin call whose operands are all constant. Returns false if some operand is
+     * not, or if the call fails.
+     */
+    bool fold(uint32_t node) {
+      arguments.clear();
+      for (uint32_t child = program.ends[node + 1]; child < program.ends[node]; child = program.ends[child]) {
+        if (!isConstant(child)) {
+          return false;
+        }
+        arguments.push_back(constantValue(child));
+      }
+
+      Expression value;
+      try {
+        nodes[node].procedure(arguments.data(), arguments.size(), value);
+      } catch (const InterpreterSemanticError&) {
+        return false; // Reported when the call is evaluated, exactly as without optimization
+      }
+      makeConstant(node, std::move(value));
+      return true;
+    }
+
+    /**
+     * Applies the identities of a builtin call with two operands.
+     */
+    void simplify(uint32_t node) {
+      if (program.payloads[node] != 3) {
+        return;
+      }
+      uint32_t left = program.ends[node + 1];
+      uint32_t right = program.ends[left];
+      switch (program.symbol(node + 1).value) {
+        case SYMBOL_SUBTRACT:
+          simplifyIdentity(node, left, right, 0);
+          break;
+        case SYMBOL_MULTIPLY:
+          if (!simplifyIdentity(node, left, right, 1)) {
+            simplifyIdentity(node, right, left, 1);
+          }
+          break;
+        case SYMBOL_DIVIDE:
+        case SYMBOL_POW:
+          simplifyIdentity(node, left, right, 1);
+          break;
+        default:
+          break;
+      }
+    }
+
+    /**
+     * Makes `node` an alias of `operand` if `identity` is the number `other` and `operand` always
+     * evaluates to a number or reports an error.
+     */
+    bool simplifyIdentity(uint32_t node, uint32_t operand, uint32_t other, double identity) {
+      if (!isConstant(other) || !producesNumber(operand)) {
+        return false;
+      }
+      Expression value = constantValue(other);
+      if (value.type != AtomType::Number || value.numValue != identity) {
+        return false;
+      }
+      makeAlias(node, operand);
+      return true;
+    }
+
+    /**
+     * Checks whether `node` evaluates to a number unless it reports an error.
+     */
+    bool producesNumber(uint32_t node) const {
+      node = resolveAlias(nodes, node);
+      switch (nodes[node].kind) {
+        case NodeKind::Literal:
+        case NodeKind::Constant:
+          return constantValue(node).type == AtomType::Number;
+        case NodeKind::BuiltinCall:
+          switch (program.symbol(node + 1).value) {
+            case SYMBOL_ADD:
+            case SYMBOL_SUBTRACT:
+            case SYMBOL_MULTIPLY:
+            case SYMBOL_DIVIDE:
+            case SYMBOL_LOG10:
+            case SYMBOL_POW:
+              return true;
+            default:
+              return false;
+          }
+        default:
+          return false;
+      }
+    }
+
+    bool isConstant(uint32_t node) const {
+      NodeKind kind = nodes[resolveAlias(nodes, node)].kind;
+      return kind == NodeKind::Literal || kind == NodeKind::Constant;
+    }
+
+    /**
+     * Returns the value of a node for which `isConstant` holds.
+     */
+    Expression constantValue(uint32_t node) const {
+      node = resolveAlias(nodes, node);
+      if (nodes[node].kind == NodeKind::Constant) {
+        return constants[nodes[node].index];
+      }
+      if (program.types[node] == AtomType::Number) {
+        return Expression(program.numbers[program.payloads[node]]);
+      }
+      return Expression(program.booleans[program.payloads[node]] != 0);
+    }
+
+    void makeConstant(uint32_t node, Expression&& value) {
+      nodes[node].kind = NodeKind::Constant;
+      nodes[node].index = static_cast<uint32_t>(constants.size());
+      constants.push_back(std::move(value));
+    }
+
+    void makeAlias(uint32_t node, uint32_t target) {
+      nodes[node].kind = NodeKind::Alias;
+      nodes[node].index = resolveAlias(nodes, target);
+    }
+
+    const FlatAst& program;
+    const Environment& environment;
+    std::vector<NodeInfo>& nodes;
+    std::vector<Expression>& constants;
+    std::vector<Expression> arguments; // Reused by every fold
+  };
+}
+
+/**
+ * Optimizes an analyzed program by rewriting entries of `nodes`.
+ */
+void optimizeProgram(const FlatAst& program, const Environment& environment, std::vector<NodeInfo>& nodes,
+                     std::vector<Expression>& constants) {
+  constants.clear();
+  Optimizer optimizer(program, environment, nodes, constants);
+  for (uint32_t node = program.size(); node-- > 0;) {
+    optimizer.optimize(node);
+  }
+}
+
+/**
+ * Returns the node that is evaluated in the place of `node`, following `Alias` nodes.
+ */
+uint32_t resolveAlias(const std::vector<NodeInfo>& nodes, uint32_t node) {
+  while (nodes[node].kind == NodeKind::Alias) {
+    node = nodes[node].index;
+  }
+  return node;
+}
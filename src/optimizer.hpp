@@ -0,0 +1,40 @@
+#ifndef OPTIMIZER_HPP // Prevent multiple inclusions
+#define OPTIMIZER_HPP   // Define a unique identifier for the header file
+
+#include <cstdint>          // Include cstdint for node indices
+#include <vector>           // Include vector for the node annotations
+#include "analysis.hpp"     // Include header file for NodeInfo
+#include "environment.hpp"  // Include header file for Environment class
+#include "expression.hpp"   // Include header file for Expression class
+#include "flat_ast.hpp"     // Include header file for FlatAst class
+
+/**
+ * This header file defines the optimization pass, which runs between analysis and compilation
+ * and rewrites the analysis of nodes whose value can be worked out ahead of time.
+ */
+
+/**
+ * Optimizes an analyzed program by rewriting entries of `nodes`, and replaces the contents of
+ * `constants` with the values of the nodes it turns into `Constant` nodes.
+ *
+ * The rewrites never change what a program does, including which errors it reports:
+ *  - Builtin calls whose operands are all constant are computed once. Calls that fail, such as
+ *    `(/ 1 0)`, are left alone, so they report their error when (and if) they are evaluated.
+ *  - Predefined constants such as `pi` are replaced by their value, since they cannot be
+ *    redefined.
+ *  - An `if` whose condition is a constant boolean becomes the branch it selects, `and` and `or`
+ *    become the constant operand that decides them, and a `begin` whose operands before the
+ *    last are all constant becomes its last operand.
+ *  - Identities that hold exactly for every number: `(- x 0)`, `(* x 1)`, `(* 1 x)`, `(/ x 1)`
+ *    and `(pow x 1)` become `x` when `x` is certain to be a number or to report an error itself.
+ *    `(+ x 0)` is not among them, since it turns -0 into 0.
+ */
+void optimizeProgram(const FlatAst& program, const Environment& environment, std::vector<NodeInfo>& nodes,
+                     std::vector<Expression>& constants);
+
+/**
+ * Returns the node that is evaluated in the place of `node`, following `Alias` nodes.
+ */
+uint32_t resolveAlias(const std::vector<NodeInfo>& nodes, uint32_t node);
+
+#endif // OPTIMIZER_HPP // Guard against multiple inclusions
@@ -0,0 +1,84 @@
+#include "procedure.hpp" // Include header file for Lambda
+#include "interpreter_semantic_error.hpp" // Include header file for InterpreterSemanticError class
+#include <iterator>      // Include iterator for std::make_move_iterator
+#include <string>        // Include string library for error messages
+#include <utility>       // Include utility for std::move
+
+/**
+ * Constructor for the `Lambda` struct, holding one reference for its creator.
+ */
+Lambda::Lambda(Expression form, uint32_t parameterCount, std::vector<SymbolId> captures)
+  : references(1), form(std::move(form)), parameterCount(parameterCount), captures(std::move(captures)) {
+  collectLambdaForms(this->form.children()[2], nested);
+}
+
+/**
+ * Drops one reference to `lambda`.
+ *
+ * The lambdas of a body are released from a work list rather than by recursion, so a deep
+ * nest of `lambda` forms is freed in constant stack space.
+ */
+void releaseLambda(Lambda* lambda) {
+  std::vector<Lambda*> pending{lambda};
+  while (!pending.empty()) {
+    lambda = pending.back();
+    pending.pop_back();
+    if (--lambda->references != 0) {
+      continue;
+    }
+    pending.insert(pending.end(), lambda->code.lambdas.begin(), lambda->code.lambdas.end());
+    lambda->code.lambdas.clear(); // Released above instead of by the destructor
+    delete lambda;
+  }
+}
+
+/**
+ * Returns a procedure made from `lambda`, capturing the `count` values at `captured`.
+ */
+Expression makeClosure(Lambda* lambda, Expression* captured, size_t count) {
+  Closure* closure = new Closure{1, lambda, std::vector<Expression>(std::make_move_iterator(captured),
+                                                                    std::make_move_iterator(captured + count))};
+  ++lambda->references;
+  return Expression(closure);
+}
+
+/**
+ * Throws unless a procedure made from `lambda` can be called with `count` arguments.
+ */
+void checkArguments(const Lambda& lambda, size_t count) {
+  if (count != lambda.parameterCount) {
+    throw InterpreterSemanticError("Error: procedure requires exactly " + std::to_string(lambda.parameterCount) +
+                                   (lambda.parameterCount == 1 ? " argument" : " arguments"));
+  }
+}
+
+/**
+ * Checks whether `exp` is a list headed by `lambda`.
+ */
+bool isLambdaForm(const Expression& exp) {
+  if (exp.type != AtomType::None || exp.children().empty()) {
+    return false;
+  }
+  const Expression& head = exp.children()[0];
+  return head.type == AtomType::Symbol && head.symbol.value == SYMBOL_LAMBDA;
+}
+
+/**
+ * Appends the `lambda` forms in `root` that are not nested inside others, in pre-order.
+ */
+void collectLambdaForms(const Expression& root, std::vector<const Expression*>& forms) {
+  std::vector<const Expression*> pending{&root};
+  while (!pending.empty()) {
+    const Expression* exp = pending.back();
+    pending.pop_back();
+    if (isLambdaForm(*exp)) {
+      forms.push_back(exp);
+      continue;
+    }
+    // Children are pushed last to first, so they are taken off the work list in order
+    const ExpressionList& children = exp->children();
+    for (size_t i = children.size(); i-- > 0;) {
+      pending.push_back(&children[i]);
+    }
+  }
+}
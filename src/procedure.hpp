@@ -0,0 +1,76 @@
+#ifndef PROCEDURE_HPP // Prevent multiple inclusions
+#define PROCEDURE_HPP   // Define a unique identifier for the header file
+
+#include <cstddef>          // Include cstddef for size_t
+#include <cstdint>          // Include cstdint for the reference counts
+#include <vector>           // Include vector for the captured variables
+#include "bytecode.hpp"     // Include header file for Bytecode
+#include "expression.hpp"   // Include header file for Expression and Closure
+#include "symbol_table.hpp" // Include header file for SymbolId
+
+/**
+ * This header file defines the procedures made by `lambda` forms.
+ *
+ * A `lambda` form is compiled once, together with the program it appears in, into a `Lambda`.
+ * Evaluating the form only makes a `Closure`, which pairs the `Lambda` with the values of the
+ * variables it captures, so making a procedure never compiles anything.
+ */
+
+/**
+ * The compiled form of one `lambda` expression, shared by every closure made from it.
+ *
+ * Variables of the body are resolved when the program is analyzed (see `analyzeProgram`): a
+ * parameter is read from its slot in the frame of the call, a variable of an enclosing
+ * procedure from its slot in `Closure::captured`, and anything else from the environment when
+ * the body runs.
+ *
+ *  - form: a copy of the `lambda` form, which the tree walker evaluates.
+ *  - captures: the variables copied into each closure, in slot order.
+ *  - nested: the `lambda` forms directly inside the body of `form`, in pre-order; the n-th one
+ *    is compiled into `code.lambdas[n]`.
+ *  - code: the body, compiled to leave the value of a call on the stack.
+ */
+struct Lambda {
+  uint32_t references;
+  Expression form;
+  uint32_t parameterCount;
+  std::vector<SymbolId> captures;
+  std::vector<const Expression*> nested;
+  Bytecode code;
+
+  /**
+   * Constructor for the `Lambda` struct, holding one reference for its creator.
+   */
+  Lambda(Expression form, uint32_t parameterCount, std::vector<SymbolId> captures);
+};
+
+/**
+ * Drops one reference to `lambda`, freeing it, and the lambdas of its body it was the last
+ * reference to, when none are left.
+ */
+void releaseLambda(Lambda* lambda);
+
+/**
+ * Returns a procedure made from `lambda`, capturing the `count` values at `captured`, which
+ * are moved from.
+ */
+Expression makeClosure(Lambda* lambda, Expression* captured, size_t count);
+
+/**
+ * Throws an `InterpreterSemanticError` unless a procedure made from `lambda` can be called
+ * with `count` arguments.
+ */
+void checkArguments(const Lambda& lambda, size_t count);
+
+/**
+ * Checks whether `exp` is a list headed by `lambda`.
+ */
+bool isLambdaForm(const Expression& exp);
+
+/**
+ * Appends to `forms` the `lambda` forms in `root`, including `root` itself, in pre-order,
+ * without those nested inside other `lambda` forms.
+ */
+void collectLambdaForms(const Expression& root, std::vector<const Expression*>& forms);
+
+#endif // PROCEDURE_HPP // Guard against multiple inclusions
@@ -0,0 +1,50 @@
+// src/slisp_aot.cpp
+//
+// Translates a Slisp script into C++ source (see aot.hpp), writing <output>.cpp, which defines
+// `Expression <function>(Environment& environment)`, and <output>.hpp, which declares it. The
+// source is built against the interpreter library; slisp_add_aot_library in CMakeLists.txt does
+// both steps for a script.
+//
+// Usage: slisp-aot <script.slp> <output> <function>
+#include "aot.hpp"
+#include "interpreter.hpp"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+int main(int argc, char* argv[]) {
+    if (argc != 4) {
+        std::cerr << "Usage: slisp-aot <script.slp> <output> <function>" << std::endl;
+        return 1;
+    }
+    std::string function = argv[3];
+    if (!isTranslatableName(function)) {
+        std::cerr << "Error: " << function << " is not a valid C++ function name" << std::endl;
+        return 1;
+    }
+
+    Interpreter interpreter;
+    if (!interpreter.parseFile(argv[1])) {
+        std::cerr << "Error: Failed to parse " << argv[1] << std::endl;
+        return 1;
+    }
+    std::ostringstream source;
+    try {
+        interpreter.translate(function, source);
+    } catch (const InterpreterSemanticError & e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::string output = argv[2];
+    std::ofstream sourceFile(output + ".cpp");
+    std::ofstream headerFile(output + ".hpp");
+    sourceFile << source.str();
+    translateHeader(function, headerFile);
+    if (!sourceFile || !headerFile) {
+        std::cerr << "Error: Failed to write " << output << ".cpp and " << output << ".hpp" << std::endl;
+        return 1;
+    }
+    return 0;
+}
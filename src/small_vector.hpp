@@ -0,0 +1,242 @@
+#ifndef SMALL_VECTOR_HPP // Prevent multiple inclusions
+#define SMALL_VECTOR_HPP   // Define a unique identifier for the header file
+
+#include <cstddef>    // Include cstddef for size_t
+#include <cstdint>    // Include cstdint for the size fields
+#include <memory>     // Include memory for std::allocator and std::allocator_traits
+#include <new>        // Include new for placement new
+#include <utility>    // Include utility for std::move and std::forward
+
+/**
+ * This header file defines the `SmallVector` class template, a vector that keeps its first few
+ * elements inside the object itself and only allocates once it grows beyond them.
+ */
+template <typename T, size_t N, typename Allocator = std::allocator<T>>
+class SmallVector {
+public:
+  typedef T value_type;
+  typedef T* iterator;
+  typedef const T* const_iterator;
+  typedef Allocator allocator_type;
+
+  /**
+   * Number of elements stored inline before the vector allocates.
+   */
+  static const size_t INLINE_CAPACITY = N;
+
+  /**
+   * Constructor for the `SmallVector` class. Creates an empty vector using inline storage.
+   */
+  explicit SmallVector(const Allocator& allocator = Allocator()) noexcept
+    : elements(inlineElements()), count(0), space(N), allocator(allocator) {}
+
+  /**
+   * Copy constructor. The copy uses the allocator returned by
+   * `select_on_container_copy_construction`, like the standard containers.
+   */
+  SmallVector(const SmallVector& other)
+    : elements(inlineElements()), count(0), space(N),
+      allocator(std::allocator_traits<Allocator>::select_on_container_copy_construction(other.allocator)) {
+    reserve(other.count);
+    for (const T& element : other) {
+      new (elements + count) T(element);
+      ++count;
+    }
+  }
+
+  /**
+   * Move constructor. Takes over heap storage; elements stored inline are moved one by one.
+   */
+  SmallVector(SmallVector&& other) noexcept
+    : elements(inlineElements()), count(0), space(N), allocator(other.allocator) {
+    if (other.isInline()) {
+      for (T& element : other) {
+        new (elements + count) T(std::move(element));
+        ++count;
+      }
+      other.clear();
+    } else {
+      elements = other.elements;
+      count = other.count;
+      space = other.space;
+      other.elements = other.inlineElements();
+      other.count = 0;
+      other.space = N;
+    }
+  }
+
+  /**
+   * Copy assignment. Keeps this vector's allocator.
+   */
+  SmallVector& operator=(const SmallVector& other) {
+    if (this != &other) {
+      clear();
+      reserve(other.count);
+      for (const T& element : other) {
+        new (elements + count) T(element);
+        ++count;
+      }
+    }
+    return *this;
+  }
+
+  /**
+   * Move assignment. Steals heap storage when both vectors share an allocator.
+   */
+  SmallVector& operator=(SmallVector&& other) noexcept {
+    if (this != &other) {
+      clear();
+      if (!other.isInline() && allocator == other.allocator) {
+        release();
+        elements = other.elements;
+        count = other.count;
+        space = other.space;
+        other.elements = other.inlineElements();
+        other.count = 0;
+        other.space = N;
+      } else {
+        reserve(other.count);
+        for (T& element : other) {
+          new (elements + count) T(std::move(element));
+          ++count;
+        }
+        other.clear();
+      }
+    }
+    return *this;
+  }
+
+  /**
+   * Destructor. Destroys the elements and frees heap storage if any was allocated.
+   */
+  ~SmallVector() {
+    clear();
+    release();
+  }
+
+  void push_back(const T& value) {
+    emplace_back(value);
+  }
+
+  void push_back(T&& value) {
+    emplace_back(std::move(value));
+  }
+
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
+    if (count == space) {
+      // Construct first, so an argument that refers into this vector survives the regrowth
+      T value(std::forward<Args>(args)...);
+      grow(space == 0 ? 4 : space * 2);
+      new (elements + count) T(std::move(value));
+    } else {
+      new (elements + count) T(std::forward<Args>(args)...);
+    }
+    return elements[count++];
+  }
+
+  void pop_back() {
+    elements[--count].~T();
+  }
+
+  /**
+   * Makes room for at least `capacity` elements.
+   */
+  void reserve(size_t capacity) {
+    if (capacity > space) {
+      grow(capacity);
+    }
+  }
+
+  /**
+   * Destroys every element. Heap storage is kept for reuse.
+   */
+  void clear() noexcept {
+    for (size_t i = 0; i < count; ++i) {
+      elements[i].~T();
+    }
+    count = 0;
+  }
+
+  size_t size() const noexcept { return count; }
+  size_t capacity() const noexcept { return space; }
+  bool empty() const noexcept { return count == 0; }
+
+  T* data() noexcept { return elements; }
+  const T* data() const noexcept { return elements; }
+
+  T& operator[](size_t index) { return elements[index]; }
+  const T& operator[](size_t index) const { return elements[index]; }
+
+  T& front() { return elements[0]; }
+  const T& front() const { return elements[0]; }
+  T& back() { return elements[count - 1]; }
+  const T& back() const { return elements[count - 1]; }
+
+  iterator begin() noexcept { return elements; }
+  iterator end() noexcept { return elements + count; }
+  const_iterator begin() const noexcept { return elements; }
+  const_iterator end() const noexcept { return elements + count; }
+
+  allocator_type get_allocator() const noexcept { return allocator; }
+
+  /**
+   * Checks whether the elements are still stored inside the object.
+   */
+  bool isInline() const noexcept {
+    return elements == inlineElements();
+  }
+
+  bool operator==(const SmallVector& other) const {
+    if (count != other.count) {
+      return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      if (!(elements[i] == other.elements[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool operator!=(const SmallVector& other) const {
+    return !(*this == other);
+  }
+
+private:
+  T* inlineElements() noexcept { return reinterpret_cast<T*>(storage); }
+  const T* inlineElements() const noexcept { return reinterpret_cast<const T*>(storage); }
+
+  /**
+   * Moves the elements into a new heap block of `capacity` elements.
+   */
+  void grow(size_t capacity) {
+    T* grown = allocator.allocate(capacity);
+    for (size_t i = 0; i < count; ++i) {
+      new (grown + i) T(std::move(elements[i]));
+      elements[i].~T();
+    }
+    release();
+    elements = grown;
+    space = static_cast<uint32_t>(capacity);
+  }
+
+  /**
+   * Frees heap storage, if any, and points back at the inline storage.
+   */
+  void release() noexcept {
+    if (!isInline()) {
+      allocator.deallocate(elements, space);
+      elements = inlineElements();
+      space = N;
+    }
+  }
+
+  T* elements;
+  uint32_t count;
+  uint32_t space;
+  Allocator allocator;
+  alignas(T) unsigned char storage[N > 0 ? N * sizeof(T) : 1];
+};
+
+#endif // SMALL_VECTOR_HPP // Guard against multiple inclusions
@@ -0,0 +1,140 @@
+#include "structural_index.hpp" // Include header file for the block classifiers
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SLISP_X86_SIMD 1
+#include <immintrin.h>   // Include intrinsics for the SSE2 and AVX2 classifiers
+#endif
+
+/**
+ * This namespace contains the block classifiers. Each one fills the same `BlockMasks` for a
+ * 64-byte block; they differ only in how many bytes they compare per instruction.
+ *
+ *  * `classifyScalar`: one byte at a time, used on CPUs without SIMD support.
+ *  * `classifySse2`: 16 bytes per compare.
+ *  * `classifyAvx2`: 32 bytes per compare.
+ */
+namespace {
+
+  BlockMasks classifyScalar(const char* block) {
+    BlockMasks masks = {0, 0, 0};
+    for (size_t i = 0; i < STRUCTURAL_BLOCK_SIZE; ++i) {
+      char c = block[i];
+      uint64_t bit = uint64_t(1) << i;
+      if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+        masks.whitespace |= bit;
+        masks.delimiter |= bit;
+        if (c == '\n') {
+          masks.newline |= bit;
+        }
+      } else if (c == '(' || c == ')' || c == ';') {
+        masks.delimiter |= bit;
+      }
+    }
+    return masks;
+  }
+
+#ifdef SLISP_X86_SIMD
+  __attribute__((target("sse2")))
+  BlockMasks classifySse2(const char* block) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriageReturn = _mm_set1_epi8('\r');
+    const __m128i open = _mm_set1_epi8('(');
+    const __m128i close = _mm_set1_epi8(')');
+    const __m128i semicolon = _mm_set1_epi8(';');
+
+    BlockMasks masks = {0, 0, 0};
+    for (size_t i = 0; i < STRUCTURAL_BLOCK_SIZE; i += 16) {
+      __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+      __m128i isNewline = _mm_cmpeq_epi8(bytes, newline);
+      __m128i isWhitespace = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, space), _mm_cmpeq_epi8(bytes, tab)),
+                                          _mm_or_si128(isNewline, _mm_cmpeq_epi8(bytes, carriageReturn)));
+      __m128i isStructural = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, open), _mm_cmpeq_epi8(bytes, close)),
+                                          _mm_cmpeq_epi8(bytes, semicolon));
+
+      masks.whitespace |= uint64_t(uint32_t(_mm_movemask_epi8(isWhitespace))) << i;
+      masks.newline |= uint64_t(uint32_t(_mm_movemask_epi8(isNewline))) << i;
+      masks.delimiter |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_or_si128(isWhitespace, isStructural)))) << i;
+    }
+    return masks;
+  }
+
+  __attribute__((target("avx2")))
+  BlockMasks classifyAvx2(const char* block) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i carriageReturn = _mm256_set1_epi8('\r');
+    const __m256i open = _mm256_set1_epi8('(');
+    const __m256i close = _mm256_set1_epi8(')');
+    const __m256i semicolon = _mm256_set1_epi8(';');
+
+    BlockMasks masks = {0, 0, 0};
+    for (size_t i = 0; i < STRUCTURAL_BLOCK_SIZE; i += 32) {
+      __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+      __m256i isNewline = _mm256_cmpeq_epi8(bytes, newline);
+      __m256i isWhitespace = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, space), _mm256_cmpeq_epi8(bytes, tab)),
+                                             _mm256_or_si256(isNewline, _mm256_cmpeq_epi8(bytes, carriageReturn)));
+      __m256i isStructural = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, open), _mm256_cmpeq_epi8(bytes, close)),
+                                             _mm256_cmpeq_epi8(bytes, semicolon));
+
+      masks.whitespace |= uint64_t(uint32_t(_mm256_movemask_epi8(isWhitespace))) << i;
+      masks.newline |= uint64_t(uint32_t(_mm256_movemask_epi8(isNewline))) << i;
+      masks.delimiter |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_or_si256(isWhitespace, isStructural)))) << i;
+    }
+    return masks;
+  }
+#endif
+}
+
+/**
+ * Checks whether the running CPU can execute the classifier for a given scan mode.
+ */
+bool scanModeSupported(ScanMode mode) {
+  switch (mode) {
+    case ScanMode::Auto:
+    case ScanMode::Scalar:
+      return true;
+#ifdef SLISP_X86_SIMD
+    case ScanMode::SSE2:
+      return __builtin_cpu_supports("sse2");
+    case ScanMode::AVX2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+/**
+ * Resolves `ScanMode::Auto` to the widest mode the running CPU supports.
+ *
+ * The answer for `Auto` is computed once and cached, since CPU features cannot change while
+ * the process runs.
+ */
+ScanMode resolveScanMode(ScanMode mode) {
+  if (mode == ScanMode::Auto) {
+    static const ScanMode best = scanModeSupported(ScanMode::AVX2) ? ScanMode::AVX2
+                               : scanModeSupported(ScanMode::SSE2) ? ScanMode::SSE2
+                               : ScanMode::Scalar;
+    return best;
+  }
+  return scanModeSupported(mode) ? mode : ScanMode::Scalar;
+}
+
+/**
+ * Returns the block classifier for a resolved, non-scalar scan mode.
+ */
+BlockClassifier blockClassifier(ScanMode mode) {
+  switch (mode) {
+#ifdef SLISP_X86_SIMD
+    case ScanMode::SSE2:
+      return classifySse2;
+    case ScanMode::AVX2:
+      return classifyAvx2;
+#endif
+    default:
+      return classifyScalar;
+  }
+}
@@ -0,0 +1,56 @@
+#ifndef STRUCTURAL_INDEX_HPP // Prevent multiple inclusions
+#define STRUCTURAL_INDEX_HPP   // Define a unique identifier for the header file
+
+#include <cstddef>   // Include cstddef for size_t
+#include <cstdint>   // Include cstdint for fixed-width mask types
+#include "tokenize.hpp" // Include header file for ScanMode
+
+/**
+ * This header file defines the block classifiers used by the tokenizer to find token boundaries
+ * many bytes at a time, in the style of simdjson's structural-index pass.
+ */
+
+/**
+ * Number of input bytes described by one set of `BlockMasks`.
+ */
+const size_t STRUCTURAL_BLOCK_SIZE = 64;
+
+/**
+ * Bit masks describing one block of `STRUCTURAL_BLOCK_SIZE` input bytes.
+ *
+ * Bit `i` of each mask describes byte `i` of the block:
+ *  - whitespace: the byte is a space, tab, newline or carriage return.
+ *  - newline: the byte is a newline (used to keep line numbers while skipping whitespace in bulk).
+ *  - delimiter: the byte ends an atom (whitespace, a parenthesis or `;`).
+ */
+struct BlockMasks {
+  uint64_t whitespace;
+  uint64_t newline;
+  uint64_t delimiter;
+};
+
+/**
+ * Signature of a function that classifies exactly `STRUCTURAL_BLOCK_SIZE` readable bytes.
+ */
+typedef BlockMasks (*BlockClassifier)(const char* block);
+
+/**
+ * Checks whether the running CPU can execute the classifier for a given scan mode.
+ *
+ * `ScanMode::Auto` and `ScanMode::Scalar` are always supported.
+ */
+bool scanModeSupported(ScanMode mode);
+
+/**
+ * Resolves `ScanMode::Auto` to the widest mode the running CPU supports.
+ *
+ * Explicitly requested modes that the CPU does not support fall back to `ScanMode::Scalar`.
+ */
+ScanMode resolveScanMode(ScanMode mode);
+
+/**
+ * Returns the block classifier for a resolved, non-scalar scan mode.
+ */
+BlockClassifier blockClassifier(ScanMode mode);
+
+#endif // STRUCTURAL_INDEX_HPP // Guard against multiple inclusions
@@ -0,0 +1,140 @@
+#include "symbol_table.hpp" // Include header file for the symbol table
+#include <cstring>          // Include cstring for memcmp
+#include <deque>            // Include deque for the name storage
+#include <vector>           // Include vector for the hash slots
+
+namespace {
+
+  /**
+   * Names of the `PredefinedSymbol` values, in the same order.
+   */
+  const char* const predefinedNames[PREDEFINED_SYMBOL_COUNT] = {
+    "define", "begin", "if", "lambda", "let",
+    "pi",
+    "+", "-", "*", "/",
+    "<", "<=", ">", ">=", "=",
+    "not", "and", "or",
+    "log10", "pow"
+  };
+
+  /**
+   * Open-addressing hash table from names to ids.
+   *
+   * Lookups hash the characters in place, so finding a name that is already interned never
+   * builds a `std::string`. Names live in a deque, whose elements never move, so references
+   * returned by `name` stay valid as the table grows.
+   */
+  class Table {
+  public:
+    Table() : slots(64, 0) {
+      for (const char* name : predefinedNames) {
+        intern(name, std::strlen(name));
+      }
+    }
+
+    SymbolId intern(const char* name, size_t length) {
+      uint64_t hash = hashName(name, length);
+      size_t mask = slots.size() - 1;
+      for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+        uint32_t slot = slots[i];
+        if (slot == 0) {
+          break;
+        }
+        const std::string& existing = names[slot - 1];
+        if (hashes[slot - 1] == hash && existing.size() == length &&
+            std::memcmp(existing.data(), name, length) == 0) {
+          return SymbolId{slot - 1};
+        }
+      }
+
+      uint32_t id = static_cast<uint32_t>(names.size());
+      names.emplace_back(name, length);
+      hashes.push_back(hash);
+      if ((names.size() + 1) * 2 > slots.size()) {
+        rehash(slots.size() * 2);
+      } else {
+        place(id);
+      }
+      return SymbolId{id};
+    }
+
+    const std::string& name(SymbolId id) const {
+      return names[id.value];
+    }
+
+    std::mutex mutex;
+
+  private:
+    static uint64_t hashName(const char* name, size_t length) {
+      // FNV-1a: symbol names are short, so a byte-at-a-time hash is cheap enough
+      uint64_t hash = 14695981039346656037ULL;
+      for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(name[i])) * 1099511628211ULL;
+      }
+      return hash;
+    }
+
+    void place(uint32_t id) {
+      size_t mask = slots.size() - 1;
+      size_t i = hashes[id] & mask;
+      while (slots[i] != 0) {
+        i = (i + 1) & mask;
+      }
+      slots[i] = id + 1;
+    }
+
+    void rehash(size_t size) {
+      slots.assign(size, 0);
+      for (uint32_t id = 0; id < names.size(); ++id) {
+        place(id);
+      }
+    }
+
+    std::vector<uint32_t> slots; // id + 1 of the name stored in each slot, 0 when empty
+    std::deque<std::string> names;
+    std::vector<uint64_t> hashes;
+  };
+
+  Table& table() {
+    static Table instance;
+    return instance;
+  }
+}
+
+/**
+ * Returns the id of a symbol name, interning it if it has not been seen before.
+ */
+SymbolId internSymbol(const char* name, size_t length) {
+  SymbolInterner interner;
+  return interner.intern(name, length);
+}
+
+/**
+ * Convenience overload of `internSymbol` for a string.
+ */
+SymbolId internSymbol(const std::string& name) {
+  return internSymbol(name.data(), name.size());
+}
+
+/**
+ * Returns the name of an interned symbol.
+ *
+ * The lock is taken because another thread may be adding names at the same time.
+ */
+const std::string& symbolName(SymbolId id) {
+  Table& symbols = table();
+  std::lock_guard<std::mutex> lock(symbols.mutex);
+  return symbols.name(id);
+}
+
+/**
+ * Constructor for the `SymbolInterner` class. Acquires the table's lock.
+ */
+SymbolInterner::SymbolInterner() : lock(table().mutex) {}
+
+/**
+ * Returns the id of a symbol name, interning it if it has not been seen before.
+ */
+SymbolId SymbolInterner::intern(const char* name, size_t length) {
+  return table().intern(name, length);
+}
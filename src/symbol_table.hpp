@@ -0,0 +1,114 @@
+#ifndef SYMBOL_TABLE_HPP // Prevent multiple inclusions
+#define SYMBOL_TABLE_HPP   // Define a unique identifier for the header file
+
+#include <cstddef>    // Include cstddef for size_t
+#include <cstdint>    // Include cstdint for the id type
+#include <mutex>      // Include mutex for SymbolInterner
+#include <string>     // Include string library for symbol names
+
+/**
+ * This header file defines the process-wide symbol table, which gives every distinct symbol
+ * name a small integer id.
+ *
+ * Symbols are interned once, when a program is tokenized. From then on the parser, the
+ * `Environment` and the evaluator only compare and hash ids; a name is turned back into text
+ * only when it is printed.
+ */
+
+/**
+ * Identifier of an interned symbol name.
+ *
+ * Ids are dense: the n-th distinct name interned by the process gets id n. Equal names always
+ * get the same id, so two symbols are the same exactly when their ids are equal.
+ */
+struct SymbolId {
+  uint32_t value;
+};
+
+inline bool operator==(SymbolId a, SymbolId b) { return a.value == b.value; }
+inline bool operator!=(SymbolId a, SymbolId b) { return a.value != b.value; }
+
+/**
+ * Symbols the interpreter knows about, interned in this order when the table is created.
+ *
+ * Their ids are therefore compile-time constants: the evaluator can dispatch on
+ * `SymbolId::value` with a `switch` or an array index instead of comparing strings. The ids
+ * are grouped so that each kind is a contiguous range:
+ *  - special forms, from `SYMBOL_DEFINE` to `SYMBOL_LET`;
+ *  - builtin constants (`SYMBOL_PI`);
+ *  - builtin procedures, from `FIRST_BUILTIN_PROCEDURE` up to `PREDEFINED_SYMBOL_COUNT`.
+ *
+ * None of them may be redefined by a program. New builtins are added by appending an entry
+ * here, its name in `symbol_table.cpp` and its procedure in `builtins.cpp`.
+ */
+enum PredefinedSymbol : uint32_t {
+  SYMBOL_DEFINE,
+  SYMBOL_BEGIN,
+  SYMBOL_IF,
+  SYMBOL_LAMBDA,
+  SYMBOL_LET,
+  SYMBOL_PI,
+  SYMBOL_ADD,
+  SYMBOL_SUBTRACT,
+  SYMBOL_MULTIPLY,
+  SYMBOL_DIVIDE,
+  SYMBOL_LESS,
+  SYMBOL_LESS_EQUAL,
+  SYMBOL_GREATER,
+  SYMBOL_GREATER_EQUAL,
+  SYMBOL_EQUAL,
+  SYMBOL_NOT,
+  SYMBOL_AND,
+  SYMBOL_OR,
+  SYMBOL_LOG10,
+  SYMBOL_POW,
+  PREDEFINED_SYMBOL_COUNT,
+  FIRST_BUILTIN_PROCEDURE = SYMBOL_ADD
+};
+
+/**
+ * Checks whether a symbol is one of the `PredefinedSymbol` values, which programs may not redefine.
+ */
+inline bool isPredefinedSymbol(SymbolId id) { return id.value < PREDEFINED_SYMBOL_COUNT; }
+
+/**
+ * Returns the id of a symbol name, interning it if it has not been seen before.
+ *
+ * It is safe to call from several threads. The table is never shrunk; it only grows with the
+ * number of distinct symbol names the process has seen.
+ */
+SymbolId internSymbol(const char* name, size_t length);
+
+/**
+ * Convenience overload of `internSymbol` for a string.
+ */
+SymbolId internSymbol(const std::string& name);
+
+/**
+ * Returns the name of an interned symbol.
+ *
+ * The returned reference stays valid for the lifetime of the process.
+ */
+const std::string& symbolName(SymbolId id);
+
+/**
+ * Interns a batch of symbol names while holding the table's lock once.
+ *
+ * The tokenizer uses it to give every symbol token of a program its id without locking and
+ * unlocking the table for each token. No other symbol table function may be called by the
+ * same thread while an interner is alive.
+ */
+class SymbolInterner {
+public:
+  SymbolInterner();
+
+  /**
+   * Returns the id of a symbol name, interning it if it has not been seen before.
+   */
+  SymbolId intern(const char* name, size_t length);
+
+private:
+  std::lock_guard<std::mutex> lock;
+};
+
+#endif // SYMBOL_TABLE_HPP // Guard against multiple inclusions
@@ -1,16 +1,24 @@
 #include "tokenize.hpp" // Include header for previously defined helper functions (assumed)
-#include <iostream>       // Include iostream library for error messages (optional)
+#include "structural_index.hpp" // Include header for the SIMD block classifiers
+#include <cstdint>        // Include cstdint for the block mask types
+#include <cstdlib>        // Include cstdlib for strtod
+#include <cstring>        // Include cstring for memcmp and memcpy
 #include <vector>        // Include vector library for storing tokens
 
 /**
- * This namespace contains helper functions used by the `tokenize` function.
+ * This namespace contains helper functions used by the tokenizer.
  * These functions are private to this file (`namespace { ... }`) to avoid polluting the global namespace.
  *
  *  * `isWhitespace(char c)`: Checks if a character is whitespace (space, tab, newline, or carriage return).
  *  * `isDigit(char c)`: Checks if a character is a digit (0-9).
- *  * `isSymbolStart(char c)`: Checks if a character can be the first character of a symbol (a-z, A-Z, or underscore).
- *  * `isSymbolChar(char c)`: Checks if a character can be part of a symbol (includes digits for extended symbol compatibility).
  *  * `isCommentStart(char c)`: Checks if a character is the start of a single-line comment (semicolon).
+ *  * `isParen(char c)`: Checks if a character is an opening or closing parenthesis.
+ *  * `isDelimiter(char c)`: Checks if a character ends an atom (whitespace, parenthesis or comment start).
+ *  * `isNumber(...)`: Checks if a character range is a complete numerical literal such as `-1` or `1e-0`.
+ *  * `looksNumeric(...)`: Checks if a character range starts the way a numerical literal does.
+ *  * `classifyAtom(...)`: Decides the token type of an atom.
+ *  * `countTrailingZeros(...)` / `countBits(...)`: Bit helpers for walking block masks.
+ *  * `scanScalar(...)` / `scanIndexed(...)`: The two scanning loops behind `scanTokens`.
  */
 namespace {
 
@@ -22,132 +30,307 @@ namespace {
     return c >= '0' && c <= '9';
   }
 
-  bool isSymbolStart(char c) {
-    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+  bool isCommentStart(char c) {
+    return c == ';';
   }
 
-  bool isSymbolChar(char c) {
-    return isSymbolStart(c) || isDigit(c);
+  bool isParen(char c) {
+    return c == '(' || c == ')';
   }
 
-  bool isCommentStart(char c) {
-    return c == ';';
+  bool isDelimiter(char c) {
+    return isWhitespace(c) || isParen(c) || isCommentStart(c);
   }
-}
 
-/**
- * This function tokenizes a Slisp expression string into a vector of individual tokens.
- *
- * The function iterates over each character in the input string and performs the following:
- *  1. Tracks line numbers for potential error reporting (optional).
- *  2. Uses a lambda function `pushToken` to add the current token to the result vector
- *     whenever whitespace is encountered or the end of the string is reached.
- *  3. Skips whitespace characters.
- *  4. Handles different token types:
- *     - Numbers: Consecutive digits are accumulated into a single token.
- *     - Symbols: Sequences of letters, digits, and underscores are considered symbols.
- *     - Comments: Characters starting with a semicolon (``) are ignored until the end of the line.
- *
- * Finally, the function pushes the last token (if any) to the result vector and returns the complete list of tokens.
- */
-// std::vector<std::string> tokenize(const std::string& input) {
-//   std::vector<std::string> tokens;
-//   std::string currentToken;
-//   size_t line = 1;
-//   size_t i;
-
-//   auto pushToken = [&]() {
-//     if (!currentToken.empty()) {
-//       tokens.push_back(currentToken);
-//       currentToken.clear();
-//     }
-//   };
-
-//   for (char c : input) {
-//     if (c == '\n') {
-//       line++;
-//     }
-
-//     if (isWhitespace(c)) {
-//       pushToken();
-//     } else {
-//       if (isDigit(c)) {
-//         // Handle numbers
-//         while (isDigit(c)) {
-//           currentToken += c;
-//           c = input[++i]; // Move to the next character without incrementing loop counter
-//         }
-//       } else if (isSymbolStart(c)) {
-//         // Handle symbols
-//         while (isSymbolChar(c)) {
-//           currentToken += c;
-//           c = input[++i]; // Move to the next character without incrementing loop counter
-//         }
-//       } else if (isCommentStart(c)) {
-//         // Skip comments until the end of the line
-//         while (c != '\n' && c != '\0') {
-//           c = input[++i]; // Move to the next character without incrementing loop counter
-//         }
-//       } else {
-//         // Other characters are treated as single-character tokens
-//         currentToken += c;
-//       }
-//     }
-//   }
-
-//   pushToken(); // Push the last token
-
-//   return tokens;
-// }
-std::vector<std::string> tokenize(const std::string& input) {
-  std::vector<std::string> tokens;
-  std::string currentToken;
-  size_t line = 1;
-  size_t i = 0; // Declare i outside the loop
-
-  auto pushToken = [&]() {
-    if (!currentToken.empty()) {
-      tokens.push_back(currentToken);
-      currentToken.clear();
+  bool isSign(char c) {
+    return c == '+' || c == '-';
+  }
+
+  bool isNumber(const char* text, size_t length) {
+    size_t i = 0;
+    size_t digits = 0;
+    if (i < length && isSign(text[i])) {
+      ++i;
+    }
+    while (i < length && isDigit(text[i])) {
+      ++i;
+      ++digits;
+    }
+    if (i < length && text[i] == '.') {
+      ++i;
+      while (i < length && isDigit(text[i])) {
+        ++i;
+        ++digits;
+      }
     }
-  };
+    if (digits == 0) {
+      return false;
+    }
+    if (i < length && (text[i] == 'e' || text[i] == 'E')) {
+      ++i;
+      if (i < length && isSign(text[i])) {
+        ++i;
+      }
+      size_t exponentDigits = 0;
+      while (i < length && isDigit(text[i])) {
+        ++i;
+        ++exponentDigits;
+      }
+      if (exponentDigits == 0) {
+        return false;
+      }
+    }
+    return i == length;
+  }
 
-  for (i = 0; i < input.size(); ++i) {
-    char c = input[i];
+  bool looksNumeric(const char* text, size_t length) {
+    if (isDigit(text[0])) {
+      return true;
+    }
+    return length > 1 && (isSign(text[0]) || text[0] == '.') && (isDigit(text[1]) || text[1] == '.');
+  }
 
-    if (c == '\n') {
-      line++;
+  Token::Type classifyAtom(const char* text, size_t length) {
+    if (isNumber(text, length)) {
+      return Token::NUMBER;
+    }
+    if (looksNumeric(text, length)) {
+      return Token::INVALID; // Something like `1abc`: neither a number nor a valid symbol
     }
+    if ((length == 4 && std::memcmp(text, "True", 4) == 0) || (length == 5 && std::memcmp(text, "False", 5) == 0)) {
+      return Token::BOOLEAN;
+    }
+    return Token::SYMBOL;
+  }
 
-    if (isWhitespace(c)) {
-      pushToken();
-    } else {
-      if (isDigit(c)) {
-        // Handle numbers
-        while (isDigit(c)) {
-          currentToken += c;
-          c = input[++i]; // Move to the next character without incrementing loop counter
-        }
-      } else if (isSymbolStart(c)) {
-        // Handle symbols
-        while (isSymbolChar(c)) {
-          currentToken += c;
-          c = input[++i]; // Move to the next character without incrementing loop counter
-        }
+  unsigned countTrailingZeros(uint64_t bits) {
+#ifdef __GNUC__
+    return static_cast<unsigned>(__builtin_ctzll(bits));
+#else
+    unsigned count = 0;
+    while ((bits & 1) == 0) {
+      bits >>= 1;
+      ++count;
+    }
+    return count;
+#endif
+  }
+
+  size_t countBits(uint64_t bits) {
+#ifdef __GNUC__
+    return static_cast<size_t>(__builtin_popcountll(bits));
+#else
+    size_t count = 0;
+    for (; bits != 0; bits &= bits - 1) {
+      ++count;
+    }
+    return count;
+#endif
+  }
+
+  void scanScalar(const char* data, size_t size, std::vector<Token>& tokens) {
+    size_t line = 1;
+    size_t i = 0;
+
+    while (i < size) {
+      char c = data[i];
+
+      if (c == '\n') {
+        line++;
+        i++;
+      } else if (isWhitespace(c)) {
+        i++;
       } else if (isCommentStart(c)) {
         // Skip comments until the end of the line
-        while (c != '\n' && c != '\0') {
-          c = input[++i]; // Move to the next character without incrementing loop counter
+        while (i < size && data[i] != '\n') {
+          i++;
         }
+      } else if (isParen(c)) {
+        tokens.push_back(Token{c == '(' ? Token::OPEN_PAREN : Token::CLOSE_PAREN, SymbolId{0}, i, 1, line});
+        i++;
       } else {
-        // Other characters are treated as single-character tokens
-        currentToken += c;
+        // Accumulate the atom up to the next delimiter
+        size_t start = i;
+        while (i < size && !isDelimiter(data[i])) {
+          i++;
+        }
+        tokens.push_back(Token{classifyAtom(data + start, i - start), SymbolId{0}, start, i - start, line});
+      }
+    }
+  }
+
+  void scanIndexed(const char* data, size_t size, BlockClassifier classify, std::vector<Token>& tokens) {
+    size_t line = 1;
+    size_t resume = 0;              // Events before this position are inside a comment
+    size_t atomStart = 0;
+    size_t atomLine = 0;
+    bool atomOpen = false;
+    uint64_t carry = 1;             // Whether the byte before the current block is a delimiter
+
+    for (size_t base = 0; base < size; base += STRUCTURAL_BLOCK_SIZE) {
+      BlockMasks m;
+      if (base + STRUCTURAL_BLOCK_SIZE <= size) {
+        m = classify(data + base);
+      } else {
+        // Pad the final partial block with spaces so it goes through the same classifier
+        char padded[STRUCTURAL_BLOCK_SIZE];
+        std::memset(padded, ' ', sizeof(padded));
+        std::memcpy(padded, data + base, size - base);
+        m = classify(padded);
+      }
+
+      // An atom starts at a non-delimiter that follows a delimiter and ends at the first
+      // delimiter after it. Parentheses and `;` are tokens of their own.
+      uint64_t afterDelimiter = (m.delimiter << 1) | carry;
+      uint64_t starts = (~m.delimiter & afterDelimiter) | (m.delimiter & ~m.whitespace);
+      uint64_t ends = m.delimiter & ~afterDelimiter;
+      uint64_t events = starts | ends;
+      uint64_t newlines = m.newline;
+      carry = m.delimiter >> (STRUCTURAL_BLOCK_SIZE - 1);
+
+      while (events != 0) {
+        unsigned bit = countTrailingZeros(events);
+        uint64_t mask = uint64_t(1) << bit;
+        size_t pos = base + bit;
+        events &= events - 1;
+
+        if (pos >= size) {
+          break; // Only padding is left; an atom still open is closed after the loop
+        }
+        if (pos < resume) {
+          continue;
+        }
+
+        uint64_t passed = newlines & (mask - 1);
+        line += countBits(passed);
+        newlines &= ~passed;
+
+        if ((ends & mask) != 0 && atomOpen) {
+          tokens.push_back(Token{classifyAtom(data + atomStart, pos - atomStart), SymbolId{0}, atomStart, pos - atomStart, atomLine});
+          atomOpen = false;
+        }
+        if ((starts & mask) != 0) {
+          char c = data[pos];
+          if (isParen(c)) {
+            tokens.push_back(Token{c == '(' ? Token::OPEN_PAREN : Token::CLOSE_PAREN, SymbolId{0}, pos, 1, line});
+          } else if (isCommentStart(c)) {
+            // Ignore every event up to the end of the line; the newline itself is counted later
+            const void* end = std::memchr(data + pos, '\n', size - pos);
+            resume = end != nullptr ? static_cast<size_t>(static_cast<const char*>(end) - data) : size;
+          } else {
+            atomStart = pos;
+            atomLine = line;
+            atomOpen = true;
+          }
+        }
       }
+
+      line += countBits(newlines);
+    }
+
+    if (atomOpen) {
+      tokens.push_back(Token{classifyAtom(data + atomStart, size - atomStart), SymbolId{0}, atomStart, size - atomStart, atomLine});
+    }
+  }
+}
+
+/**
+ * This function scans a Slisp program into position-tagged tokens.
+ *
+ * The function walks the buffer once and performs the following:
+ *  1. Tracks line numbers for error reporting.
+ *  2. Skips whitespace characters and comments (`;` up to the end of the line).
+ *  3. Emits parentheses as single-character tokens.
+ *  4. Emits every other run of characters up to the next delimiter as one atom, classified
+ *     as a number, boolean, symbol or invalid atom.
+ *
+ * No token text is copied; each token only stores its offset and length in `data`.
+ *
+ * In the SIMD scan modes the input is first classified 64 bytes at a time into bit masks, from
+ * which the start and end of every token are derived with a few bit operations. The loop then
+ * visits only those positions instead of testing every character. The scalar mode is the
+ * reference implementation and the fallback.
+ */
+std::vector<Token> scanTokens(const char* data, size_t size, ScanMode mode) {
+  std::vector<Token> tokens;
+  scanTokens(data, size, tokens, mode);
+  return tokens;
+}
+
+/**
+ * Scans a Slisp program into a caller-provided token vector.
+ *
+ * The vector is cleared first but keeps its capacity, so a caller that scans many inputs can
+ * reuse one vector and avoid reallocating it for every scan.
+ */
+void scanTokens(const char* data, size_t size, std::vector<Token>& tokens, ScanMode mode) {
+  tokens.clear();
+  ScanMode resolved = resolveScanMode(mode);
+  if (resolved == ScanMode::Scalar) {
+    scanScalar(data, size, tokens);
+  } else {
+    scanIndexed(data, size, blockClassifier(resolved), tokens);
+  }
+
+  // Intern every symbol under a single acquisition of the symbol table's lock
+  SymbolInterner interner;
+  for (Token& token : tokens) {
+    if (token.type == Token::SYMBOL) {
+      token.symbol = interner.intern(data + token.offset, token.length);
     }
-    i++;
   }
+}
 
-  pushToken(); // Push the last token
+/**
+ * Convenience overload of `scanTokens` for a string buffer.
+ */
+std::vector<Token> scanTokens(const std::string& input, ScanMode mode) {
+  return scanTokens(input.data(), input.size(), mode);
+}
+
+/**
+ * Returns a copy of the text a token refers to inside the buffer it was scanned from.
+ */
+std::string tokenText(const Token& token, const char* data) {
+  return std::string(data + token.offset, token.length);
+}
+
+/**
+ * Converts a `NUMBER` token to its numerical value.
+ *
+ * The scanned buffer is not required to be null-terminated, so the digits are copied into a
+ * small local buffer before they are handed to `strtod`.
+ */
+double tokenNumber(const Token& token, const char* data) {
+  char buffer[64];
+  if (token.length < sizeof(buffer)) {
+    std::memcpy(buffer, data + token.offset, token.length);
+    buffer[token.length] = '\0';
+    return std::strtod(buffer, nullptr);
+  }
+  return std::strtod(tokenText(token, data).c_str(), nullptr);
+}
+
+/**
+ * Converts a `BOOLEAN` token to its truth value.
+ */
+bool tokenBoolean(const Token& token, const char* data) {
+  return data[token.offset] == 'T';
+}
+
+/**
+ * This function tokenizes a Slisp expression string into a vector of individual tokens.
+ *
+ * It scans the input with `scanTokens` and copies the text of each token into its own string.
+ */
+std::vector<std::string> tokenize(const std::string& input) {
+  std::vector<Token> scanned = scanTokens(input);
+
+  std::vector<std::string> tokens;
+  tokens.reserve(scanned.size());
+  for (const auto& token : scanned) {
+    tokens.push_back(tokenText(token, input.data()));
+  }
 
   return tokens;
 }
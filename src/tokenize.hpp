@@ -1,36 +1,87 @@
-// #ifndef TOKENIZE_HPP
-// #define TOKENIZE_HPP
-
-// #pragma once
-
-// #include <string>
-// #include <vector>
-
-// struct Token {
-//     enum Type { OPEN_PAREN, CLOSE_PAREN, SYMBOL, NUMBER, BOOLEAN, STRING, COMMENT, INVALID };
-//     Type type;
-//     std::string value;
-//     size_t line;
-// };
-// std::vector<std::string> tokenize(std::string& input);
-
-// #endif
-
 #ifndef TOKENIZE_HPP
 #define TOKENIZE_HPP
 
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <vector>
+#include "symbol_table.hpp"
 
+/**
+ * A single lexical token produced by `scanTokens`.
+ *
+ * A token does not own its text. It records where the text lives in the buffer that was
+ * scanned (`offset` and `length`), so the caller must keep that buffer alive for as long as
+ * the tokens are used. The `type` is classified once during scanning so that consumers never
+ * have to inspect the characters again to decide what kind of atom they are looking at.
+ * `SYMBOL` tokens also carry the interned id of their name, so nothing downstream has to look
+ * the text up again.
+ */
 struct Token {
     enum Type { OPEN_PAREN, CLOSE_PAREN, SYMBOL, NUMBER, BOOLEAN, STRING, COMMENT, INVALID };
     Type type;
-    std::string value;
+    SymbolId symbol; // Only meaningful for `SYMBOL` tokens
+    size_t offset;
+    size_t length;
     size_t line;
 };
 
+/**
+ * Selects how `scanTokens` looks for token boundaries.
+ *
+ *  - Auto: use the widest SIMD classifier the running CPU supports.
+ *  - Scalar: test one character at a time.
+ *  - SSE2: classify 16 bytes per compare.
+ *  - AVX2: classify 32 bytes per compare.
+ */
+enum class ScanMode { Auto, Scalar, SSE2, AVX2 };
+
+/**
+ * Scans a Slisp program into position-tagged tokens without copying any of its text.
+ *
+ * Parentheses are always single-character tokens. Any other run of characters up to the next
+ * whitespace, parenthesis or comment is one atom, classified as `NUMBER`, `BOOLEAN` (`True` or
+ * `False`), `SYMBOL`, or `INVALID` when it starts like a number but is not one (e.g. `1abc`).
+ * Comments (`;` up to the end of the line) are skipped and do not produce tokens. Symbol
+ * names are interned (see `internSymbol`) once all tokens have been found.
+ *
+ * Every scan mode produces the same tokens; `mode` only changes how fast they are found.
+ */
+std::vector<Token> scanTokens(const char* data, size_t size, ScanMode mode = ScanMode::Auto);
+
+/**
+ * Scans a Slisp program into a caller-provided token vector.
+ *
+ * The vector is cleared first but keeps its capacity, so it can be reused across scans.
+ */
+void scanTokens(const char* data, size_t size, std::vector<Token>& tokens, ScanMode mode = ScanMode::Auto);
+
+/**
+ * Convenience overload of `scanTokens` for a string buffer.
+ */
+std::vector<Token> scanTokens(const std::string& input, ScanMode mode = ScanMode::Auto);
+
+/**
+ * Returns a copy of the text a token refers to inside the buffer it was scanned from.
+ */
+std::string tokenText(const Token& token, const char* data);
+
+/**
+ * Converts a `NUMBER` token to its numerical value.
+ */
+double tokenNumber(const Token& token, const char* data);
+
+/**
+ * Converts a `BOOLEAN` token to its truth value.
+ */
+bool tokenBoolean(const Token& token, const char* data);
+
+/**
+ * Splits a Slisp program into a vector of token strings.
+ *
+ * This is a copying wrapper around `scanTokens` kept for callers that want owned strings.
+ */
 std::vector<std::string> tokenize(const std::string& input);
 
 #endif
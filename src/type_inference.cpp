@@ -0,0 +1,175 @@
+#include "type_inference.hpp" // Include header file for the type inference pass
+
+namespace {
+
+  /**
+   * Rounds of proofs about variables before the pass gives up on them. Each round only
+   * withdraws proofs, so this bounds the pass to a few linear scans of the program.
+   */
+  const int MAX_ROUNDS = 8;
+
+  StaticType typeOf(const Expression& value) {
+    switch (value.type) {
+      case AtomType::Number: return StaticType::Number;
+      case AtomType::Boolean: return StaticType::Boolean;
+      default: return StaticType::Unknown;
+    }
+  }
+
+  /**
+   * Infers the types of every node, given the types of the variables.
+   */
+  class TypeInference {
+  public:
+    TypeInference(const FlatAst& program, const std::vector<NodeInfo>& nodes, const std::vector<Expression>& folded,
+                  const std::vector<StaticType>& variables, std::vector<StaticType>& types)
+      : program(program), nodes(nodes), folded(folded), variables(variables), types(types) {
+      markProcedureBodies();
+    }
+
+    /**
+     * Computes `types` from the leaves up, visiting nodes in reverse storage order.
+     */
+    void run() {
+      types.assign(program.size(), StaticType::Unknown);
+      for (uint32_t node = program.size(); node-- > 0;) {
+        types[node] = infer(node);
+      }
+    }
+
+  private:
+    StaticType infer(uint32_t node) const {
+      uint32_t first = node + 1;
+      switch (nodes[node].kind) {
+        case NodeKind::Literal:
+          return program.types[node] == AtomType::Number ? StaticType::Number : StaticType::Boolean;
+        case NodeKind::Constant:
+          return typeOf(folded[nodes[node].index]);
+        case NodeKind::Alias:
+          return types[nodes[node].index];
+        case NodeKind::Variable:
+          // A procedure may be called after later programs have changed the variable
+          return inBody[node] ? StaticType::Unknown : variables[program.symbol(node).value];
+        case NodeKind::Define:
+          return types[program.ends[program.ends[first]]];
+        case NodeKind::Begin: {
+          uint32_t last = program.ends[first];
+          while (program.ends[last] != program.ends[node]) {
+            last = program.ends[last];
+          }
+          return types[last];
+        }
+        case NodeKind::If: {
+          uint32_t consequent = program.ends[program.ends[first]];
+          StaticType type = types[consequent];
+          return type == types[program.ends[consequent]] ? type : StaticType::Unknown;
+        }
+        case NodeKind::Let:
+          return types[program.ends[program.ends[first]]];
+        case NodeKind::And:
+        case NodeKind::Or:
+          return StaticType::Boolean;
+        case NodeKind::BuiltinCall:
+          switch (program.symbol(first).value) {
+            case SYMBOL_ADD:
+            case SYMBOL_SUBTRACT:
+            case SYMBOL_MULTIPLY:
+            case SYMBOL_DIVIDE:
+            case SYMBOL_LOG10:
+            case SYMBOL_POW:
+              return StaticType::Number;
+            default:
+              return StaticType::Boolean;
+          }
+        case NodeKind::Apply:
+          // A list of a single value evaluates to that value; a single symbol would be a call
+          return program.payloads[node] == 1 ? types[first] : StaticType::Unknown;
+        case NodeKind::Lambda:
+        case NodeKind::Parameters:
+        case NodeKind::Local:
+        case NodeKind::Captured:
+          return StaticType::Unknown;
+      }
+      return StaticType::Unknown;
+    }
+
+    /**
+     * Fills `inBody`, which tells the nodes inside `lambda` forms apart.
+     */
+    void markProcedureBodies() {
+      inBody.assign(program.size(), false);
+      uint32_t end = 0; // End of the outermost `lambda` form around the node
+      for (uint32_t node = 0; node < program.size(); ++node) {
+        if (node < end) {
+          inBody[node] = true;
+        } else if (nodes[node].kind == NodeKind::Lambda) {
+          end = program.ends[node];
+        }
+      }
+    }
+
+    const FlatAst& program;
+    const std::vector<NodeInfo>& nodes;
+    const std::vector<Expression>& folded;
+    const std::vector<StaticType>& variables;
+    std::vector<StaticType>& types;
+    std::vector<bool> inBody;
+  };
+}
+
+/**
+ * Infers the static type of every node of an analyzed program.
+ *
+ * Variables start out with the type of their current value. Each round infers the node types
+ * under those assumptions, then withdraws the assumption for every variable that some `define`
+ * contradicts, until the assumptions hold.
+ */
+void inferTypes(const FlatAst& program, const Environment& environment, const std::vector<NodeInfo>& nodes,
+                const std::vector<Expression>& folded, std::vector<StaticType>& types) {
+  std::vector<StaticType> variables;
+  for (SymbolId symbol : program.symbols) {
+    if (symbol.value >= variables.size()) {
+      variables.resize(symbol.value + 1, StaticType::Unknown);
+    }
+    const Expression* value = environment.find(symbol);
+    variables[symbol.value] = value != nullptr ? typeOf(*value) : StaticType::Unknown;
+  }
+
+  TypeInference inference(program, nodes, folded, variables, types);
+  for (int round = 0;; ++round) {
+    inference.run();
+    if (round == MAX_ROUNDS) {
+      return; // Every assumption was withdrawn before this round
+    }
+
+    bool changed = false;
+    for (uint32_t node = 0; node < program.size(); ++node) {
+      uint32_t first = node + 1;
+      if (nodes[node].kind == NodeKind::Define) {
+        uint32_t name = program.ends[first];
+        StaticType& assumed = variables[program.symbol(name).value];
+        if (assumed != StaticType::Unknown && assumed != types[program.ends[name]]) {
+          assumed = StaticType::Unknown;
+          changed = true;
+        }
+      } else if (nodes[node].kind == NodeKind::Apply && program.payloads[node] >= 2 &&
+                 types[first] == StaticType::Unknown) {
+        // A call whose procedure is not proven to be a number or boolean might be `define`, or
+        // a procedure whose body defines anything
+        for (StaticType& assumed : variables) {
+          changed = changed || assumed != StaticType::Unknown;
+          assumed = StaticType::Unknown;
+        }
+      }
+    }
+    if (!changed) {
+      return;
+    }
+    if (round + 1 == MAX_ROUNDS) {
+      // Give up on variables rather than keep scanning
+      for (StaticType& assumed : variables) {
+        assumed = StaticType::Unknown;
+      }
+    }
+  }
+}
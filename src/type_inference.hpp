@@ -0,0 +1,37 @@
+#ifndef TYPE_INFERENCE_HPP // Prevent multiple inclusions
+#define TYPE_INFERENCE_HPP   // Define a unique identifier for the header file
+
+#include <cstdint>          // Include cstdint for the static types
+#include <vector>           // Include vector for the node types
+#include "analysis.hpp"     // Include header file for NodeInfo
+#include "environment.hpp"  // Include header file for Environment class
+#include "expression.hpp"   // Include header file for Expression class
+#include "flat_ast.hpp"     // Include header file for FlatAst class
+
+/**
+ * This header file defines the type inference pass, which works out which nodes of a program
+ * always evaluate to a number (or a boolean), so the compiler can keep their values unboxed.
+ */
+
+/**
+ * The type a node is proven to evaluate to whenever its evaluation does not report an error.
+ * `Unknown` means no such proof was found.
+ */
+enum class StaticType : uint8_t { Unknown, Number, Boolean };
+
+/**
+ * Infers the static type of every node of an analyzed (and optionally optimized, with its
+ * constants in `folded`) program, replacing the contents of `types`.
+ *
+ * Calls of arithmetic builtins are numbers and calls of relational and logical ones booleans,
+ * whatever their operands, since anything else is an error. A variable is proven to have a type
+ * when it is bound to a value of that type in `environment` and every `define` of it in the
+ * program gives it a value of that same type: the program is then the only thing that changes
+ * it. A call whose procedure is only known at run time might be a hidden `define`, or run a
+ * procedure that defines anything, in which case no variable is proven. Variables in the body of
+ * a `lambda` form are never proven, since the procedure may outlive the program.
+ */
+void inferTypes(const FlatAst& program, const Environment& environment, const std::vector<NodeInfo>& nodes,
+                const std::vector<Expression>& folded, std::vector<StaticType>& types);
+
+#endif // TYPE_INFERENCE_HPP // Guard against multiple inclusions
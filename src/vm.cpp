@@ -0,0 +1,544 @@
+#include "vm.hpp"       // Include header file for VirtualMachine class
+#include "analysis.hpp" // Include header file for checkArity
+#include "procedure.hpp" // Include header file for Lambda
+#include "interpreter_semantic_error.hpp" // Include header file for InterpreterSemanticError class
+#include <cmath>        // Include cmath for pow and log10
+#include <utility>      // Include utility for std::move
+
+/**
+ * The dispatch loop below is written once, with macros for the parts that differ between the
+ * two dispatch modes:
+ *  - Threaded (`SLISP_THREADED_DISPATCH`, set by CMake when the compiler supports labels as
+ *    values): every handler ends with its own indirect jump to the next handler, so the branch
+ *    predictor sees one jump per opcode and can learn common opcode sequences.
+ *  - Switch: the portable fallback, a `switch` in a loop with a single shared indirect jump.
+ *
+ * `HANDLER(name)` starts the handler for `Opcode::name` and `NEXT()` ends it.
+ */
+#ifdef SLISP_COUNT_OPCODES
+#define COUNT_OPCODE(opcode) \
+  do { \
+    OpcodeCounts& counts = opcodeCounts(); \
+    ++counts.executed[static_cast<size_t>(opcode)]; \
+    ++counts.pairs[static_cast<size_t>(previous)][static_cast<size_t>(opcode)]; \
+    previous = opcode; \
+  } while (false)
+#else
+#define COUNT_OPCODE(opcode) do {} while (false)
+#endif
+
+#ifdef SLISP_THREADED_DISPATCH
+#define DISPATCH_LOOP goto *labels[static_cast<size_t>(ip->opcode)];
+#define HANDLER(name) handle##name: COUNT_OPCODE(Opcode::name);
+#define NEXT() goto *labels[static_cast<size_t>(ip->opcode)]
+#else
+#define DISPATCH_LOOP while (true) switch (ip->opcode)
+#define HANDLER(name) case Opcode::name: COUNT_OPCODE(Opcode::name);
+#define NEXT() continue
+#endif
+
+/**
+ * Body of the inline binary operations. The left operand's slot receives the result; the
+ * right operand is either the top of the stack or a constant (see `Opcode`).
+ */
+#define BINARY_OPERATION(symbol, resultType, resultMember, expression) \
+  { \
+    Expression* left = &stack.back() - (ip->count - 1); \
+    const Expression* right = ip->count == 2 ? &stack.back() : &code->constants[ip->operand]; \
+    if (left->type != AtomType::Number || right->type != AtomType::Number || \
+        (symbol == SYMBOL_DIVIDE && right->numValue == 0)) { \
+      callBinaryBuiltin(*code, *ip, SymbolId{symbol}); \
+    } else { \
+      double a = left->numValue; \
+      double b = right->numValue; \
+      left->type = resultType; \
+      left->resultMember = (expression); \
+      if (ip->count == 2) { \
+        stack.pop_back(); \
+      } \
+    } \
+    ++ip; \
+    NEXT(); \
+  }
+
+/**
+ * Body of `and` and `or`, which end early when an operand equals `decisive`.
+ */
+#define SHORT_CIRCUIT(name, decisive) \
+  { \
+    if (stack.back().type != AtomType::Boolean) { \
+      throw InterpreterSemanticError("Error: " name " requires boolean arguments"); \
+    } \
+    if (stack.back().boolValue == decisive) { \
+      ip = start + ip->operand; \
+    } else { \
+      if (ip->count == 0) { \
+        stack.pop_back(); \
+      } \
+      ++ip; \
+    } \
+    NEXT(); \
+  }
+
+/**
+ * Replaces the top two numbers, `a` below `b`, by `expression`.
+ */
+#define NUMBER_OPERATION(expression) \
+  { \
+    double b = numbers.back(); \
+    numbers.pop_back(); \
+    double a = numbers.back(); \
+    numbers.back() = (expression); \
+  }
+
+/**
+ * Body of the variadic numeric operations: folds the top `count` numbers into `initial` in
+ * order with `assign`, as the builtin procedures do.
+ */
+#define NUMBER_FOLD(initial, assign) \
+  { \
+    size_t base = numbers.size() - ip->count; \
+    double result = initial; \
+    for (size_t i = base; i < numbers.size(); ++i) { \
+      result assign numbers[i]; \
+    } \
+    numbers.resize(base + 1); \
+    numbers[base] = result; \
+    ++ip; \
+    NEXT(); \
+  }
+
+/**
+ * Body of the numeric comparisons, which end a region with a boolean on the value stack.
+ */
+#define NUMBER_COMPARISON(comparison) \
+  { \
+    double b = numbers.back(); \
+    numbers.pop_back(); \
+    double a = numbers.back(); \
+    numbers.pop_back(); \
+    stack.emplace_back(a comparison b); \
+    ++ip; \
+    NEXT(); \
+  }
+
+#ifdef SLISP_COUNT_OPCODES
+/**
+ * Returns the process-wide opcode counters.
+ */
+OpcodeCounts& opcodeCounts() {
+  static OpcodeCounts counts = {};
+  return counts;
+}
+#endif
+
+/**
+ * Starts running the body of the procedure on the stack right below its `count` arguments,
+ * which become the arguments of the call, followed by the slots of its `let` variables.
+ */
+#define ENTER_PROCEDURE(count) \
+  { \
+    closure = stack[base - 1].closure; \
+    checkArguments(*closure->lambda, count); \
+    code = &closure->lambda->code; \
+    if (code->frameSize != count) { \
+      stack.resize(base + code->frameSize); \
+    } \
+    start = code->instructions.data(); \
+    ip = start; \
+    NEXT(); \
+  }
+
+/**
+ * Constructor for the `VirtualMachine` class.
+ */
+VirtualMachine::VirtualMachine(Environment& environment)
+  : environment(environment), depthLimit(DEFAULT_DEPTH_LIMIT), jit(true) {}
+
+/**
+ * Sets how many procedure calls may be open at once.
+ */
+void VirtualMachine::setDepthLimit(size_t limit) {
+  depthLimit = limit;
+}
+
+/**
+ * Enables or disables running hot numeric regions as machine code. Has no effect unless the
+ * JIT is built in (see `jit.hpp`).
+ */
+void VirtualMachine::setJit(bool enabled) {
+  jit = enabled;
+}
+
+/**
+ * Runs a compiled program and returns its value.
+ *
+ * The loop keeps an instruction pointer into the stream; jumps simply move it. Every value
+ * lives on one contiguous stack, and builtins read their arguments from it in place.
+ *
+ * A procedure call leaves the procedure and its arguments where they are: the arguments are
+ * the first slots of its frame, which `LoadLocal` reads from `base` on, followed by those of
+ * its `let` variables, and the procedure below them keeps its closure alive for `LoadCaptured`.
+ * The program's own frame, for its `let` variables, is at the bottom of the stack. The caller's
+ * registers are saved in `calls` until the callee's `Return` puts its value in the procedure's
+ * place.
+ */
+Expression VirtualMachine::run(Bytecode& program) {
+#ifdef SLISP_THREADED_DISPATCH
+  // Indexed by opcode, so the order must match the `Opcode` enumeration
+  static const void* const labels[OPCODE_COUNT] = {
+    &&handlePushConstant, &&handleLoadVariable, &&handleLoadLocal, &&handleStoreLocal, &&handleLoadCaptured,
+    &&handleDefine, &&handlePop, &&handleJump, &&handleJumpIfFalse, &&handleCallBuiltin, &&handleApply,
+    &&handleTailApply, &&handleMakeClosure, &&handleAdd, &&handleSubtract,
+    &&handleMultiply, &&handleDivide, &&handleLess, &&handleLessEqual, &&handleGreater,
+    &&handleGreaterEqual, &&handleEqual, &&handlePower, &&handleAnd, &&handleOr, &&handlePushNumber,
+    &&handleLoadNumber, &&handleLoadProvenNumber, &&handleUnbox, &&handleAddNumbers, &&handleSubtractNumbers,
+    &&handleMultiplyNumbers, &&handleDivideNumbers, &&handlePowerNumbers, &&handleLog10Number,
+    &&handleLessNumbers, &&handleLessEqualNumbers, &&handleGreaterNumbers, &&handleGreaterEqualNumbers,
+    &&handleEqualNumbers, &&handleBox, &&handleEnterRegion, &&handleReturn
+  };
+#endif
+#ifdef SLISP_COUNT_OPCODES
+  Opcode previous = Opcode::Return; // A run starts as if it followed a return
+#endif
+
+  stack.clear();
+  stack.resize(program.frameSize); // The slots of the program's `let` variables
+  numbers.clear();
+  calls.clear();
+  Bytecode* code = &program;
+  const Instruction* start = code->instructions.data();
+  const Instruction* ip = start;
+  size_t base = 0;                  // Index of the first argument of the call being run
+  const Closure* closure = nullptr; // Closure of the call being run
+  DISPATCH_LOOP {
+    HANDLER(PushConstant) {
+      stack.push_back(code->constants[ip->operand]);
+      ++ip;
+      NEXT();
+    }
+    HANDLER(LoadVariable) {
+      SymbolId symbol{ip->operand};
+      const Expression* bound = environment.find(symbol);
+      if (bound != nullptr) {
+        stack.push_back(*bound);
+      } else {
+        stack.emplace_back(symbol);
+      }
+      ++ip;
+      NEXT();
+    }
+    HANDLER(LoadLocal) {
+      stack.push_back(stack[base + ip->operand]); // Copied before the stack grows
+      ++ip;
+      NEXT();
+    }
+    HANDLER(StoreLocal) {
+      stack[base + ip->operand] = std::move(stack.back());
+      stack.pop_back();
+      ++ip;
+      NEXT();
+    }
+    HANDLER(LoadCaptured) {
+      stack.push_back(closure->captured[ip->operand]);
+      ++ip;
+      NEXT();
+    }
+    HANDLER(Define) {
+      if (ip->count == 1) {
+        environment.addSymbol(SymbolId{ip->operand}, std::move(stack.back()));
+        stack.pop_back();
+      } else {
+        environment.addSymbol(SymbolId{ip->operand}, stack.back());
+      }
+      ++ip;
+      NEXT();
+    }
+    HANDLER(Pop) {
+      stack.pop_back();
+      ++ip;
+      NEXT();
+    }
+    HANDLER(Jump) {
+      ip = start + ip->operand;
+      NEXT();
+    }
+    HANDLER(JumpIfFalse) {
+      if (stack.back().type != AtomType::Boolean) {
+        throw InterpreterSemanticError("Error: if requires a boolean condition");
+      }
+      bool condition = stack.back().boolValue;
+      stack.pop_back();
+      ip = condition ? ip + 1 : start + ip->operand;
+      NEXT();
+    }
+    HANDLER(CallBuiltin) {
+      // The result replaces the first argument, so the stack shrinks without reallocating
+      size_t first = stack.size() - ip->count;
+      Expression value;
+      code->procedures[ip->operand](stack.data() + first, ip->count, value);
+      stack[first] = std::move(value);
+      stack.resize(first + 1);
+      ++ip;
+      NEXT();
+    }
+    HANDLER(TailApply) {
+      size_t first = stack.size() - ip->count;
+      if (stack[first].type == AtomType::Procedure && !calls.empty()) {
+        // The callee and its arguments take the place of the current call's, which is finished
+        size_t count = ip->count;
+        for (size_t i = 0; i < count; ++i) {
+          stack[base - 1 + i] = std::move(stack[first + i]);
+        }
+        stack.resize(base - 1 + count);
+        ENTER_PROCEDURE(count - 1)
+      }
+      goto applyElements;
+    }
+    HANDLER(Apply) {
+    applyElements:
+      size_t first = stack.size() - ip->count;
+      if (stack[first].type == AtomType::Procedure) {
+        checkDepth(calls.size() + 1, depthLimit);
+        calls.push_back(CallFrame{code, ip + 1, base, closure});
+        base = first + 1;
+        ENTER_PROCEDURE(ip->count - 1)
+      }
+      Expression value;
+      applyList(environment, stack.data() + first, ip->count, value);
+      stack.resize(first);
+      stack.push_back(std::move(value));
+      ++ip;
+      NEXT();
+    }
+    HANDLER(MakeClosure) {
+      size_t first = stack.size() - ip->count;
+      Expression value = makeClosure(code->lambdas[ip->operand], stack.data() + first, ip->count);
+      stack.resize(first);
+      stack.push_back(std::move(value));
+      ++ip;
+      NEXT();
+    }
+    HANDLER(Add) BINARY_OPERATION(SYMBOL_ADD, AtomType::Number, numValue, 0.0 + a + b)
+    HANDLER(Subtract) BINARY_OPERATION(SYMBOL_SUBTRACT, AtomType::Number, numValue, a - b)
+    HANDLER(Multiply) BINARY_OPERATION(SYMBOL_MULTIPLY, AtomType::Number, numValue, a * b)
+    HANDLER(Divide) BINARY_OPERATION(SYMBOL_DIVIDE, AtomType::Number, numValue, a / b)
+    HANDLER(Less) BINARY_OPERATION(SYMBOL_LESS, AtomType::Boolean, boolValue, a < b)
+    HANDLER(LessEqual) BINARY_OPERATION(SYMBOL_LESS_EQUAL, AtomType::Boolean, boolValue, a <= b)
+    HANDLER(Greater) BINARY_OPERATION(SYMBOL_GREATER, AtomType::Boolean, boolValue, a > b)
+    HANDLER(GreaterEqual) BINARY_OPERATION(SYMBOL_GREATER_EQUAL, AtomType::Boolean, boolValue, a >= b)
+    HANDLER(Equal) BINARY_OPERATION(SYMBOL_EQUAL, AtomType::Boolean, boolValue, a == b)
+    HANDLER(Power) BINARY_OPERATION(SYMBOL_POW, AtomType::Number, numValue, b == 2 ? a * a : std::pow(a, b))
+    HANDLER(And) SHORT_CIRCUIT("and", false)
+    HANDLER(Or) SHORT_CIRCUIT("or", true)
+    HANDLER(PushNumber) {
+      numbers.push_back(code->numbers[ip->operand]);
+      ++ip;
+      NEXT();
+    }
+    HANDLER(LoadNumber) {
+      const Expression* bound = environment.find(SymbolId{ip->operand});
+      if (bound != nullptr && bound->type == AtomType::Number) {
+        numbers.push_back(bound->numValue);
+        ++ip;
+      } else {
+        numbers.clear();
+        ip = start + ip->count;
+      }
+      NEXT();
+    }
+    HANDLER(LoadProvenNumber) {
+      numbers.push_back(environment.find(SymbolId{ip->operand})->numValue);
+      ++ip;
+      NEXT();
+    }
+    HANDLER(Unbox) {
+      numbers.push_back(stack.back().numValue);
+      stack.pop_back();
+      ++ip;
+      NEXT();
+    }
+    HANDLER(AddNumbers) NUMBER_FOLD(0.0, +=)
+    HANDLER(SubtractNumbers) {
+      if (ip->count == 1) {
+        numbers.back() = -numbers.back();
+      } else {
+        NUMBER_OPERATION(a - b)
+      }
+      ++ip;
+      NEXT();
+    }
+    HANDLER(MultiplyNumbers) NUMBER_FOLD(1.0, *=)
+    HANDLER(DivideNumbers) {
+      if (numbers.back() == 0) {
+        throw InterpreterSemanticError("Error: Division by zero");
+      }
+      NUMBER_OPERATION(a / b)
+      ++ip;
+      NEXT();
+    }
+    HANDLER(PowerNumbers) {
+      NUMBER_OPERATION(b == 2 ? a * a : std::pow(a, b))
+      ++ip;
+      NEXT();
+    }
+    HANDLER(Log10Number) {
+      numbers.back() = std::log10(numbers.back());
+      ++ip;
+      NEXT();
+    }
+    HANDLER(LessNumbers) NUMBER_COMPARISON(<)
+    HANDLER(LessEqualNumbers) NUMBER_COMPARISON(<=)
+    HANDLER(GreaterNumbers) NUMBER_COMPARISON(>)
+    HANDLER(GreaterEqualNumbers) NUMBER_COMPARISON(>=)
+    HANDLER(EqualNumbers) NUMBER_COMPARISON(==)
+    HANDLER(Box) {
+      stack.emplace_back(numbers.back());
+      numbers.pop_back();
+      ++ip;
+      NEXT();
+    }
+    HANDLER(EnterRegion) {
+#ifdef SLISP_JIT
+      NumericRegion& region = code->regions[ip->operand];
+      if (jit && region.runs < JIT_THRESHOLD && ++region.runs == JIT_THRESHOLD) {
+        region.native = code->native.compile(start + region.start, start + region.end, code->numbers);
+      }
+      if (jit && region.native >= 0 && code->native.region(region.native).function != nullptr) {
+        // The number stack is empty between regions, so it holds the inputs
+        const NativeRegion& native = code->native.region(region.native);
+        bool guarded = true;
+        for (uint32_t i = 0; i < native.inputCount; ++i) {
+          const Expression* bound = environment.find(code->native.input(native.firstInput + i));
+          if (bound == nullptr || bound->type != AtomType::Number) {
+            guarded = false;
+            break;
+          }
+          numbers.push_back(bound->numValue);
+        }
+        if (!guarded) {
+          numbers.clear();
+          ip = start + region.fallback;
+          NEXT();
+        }
+        double result;
+        int status = native.function(numbers.data(), &result);
+        numbers.clear();
+        if (status < 0) {
+          throw InterpreterSemanticError("Error: Division by zero");
+        }
+        if (native.comparison) {
+          stack.emplace_back(status != 0);
+        } else {
+          stack.emplace_back(result);
+        }
+        ip = start + region.end;
+        NEXT();
+      }
+#endif
+      ++ip;
+      NEXT();
+    }
+    HANDLER(Return) {
+      if (calls.empty()) {
+        Expression result = std::move(stack.back());
+        stack.clear();
+        return result;
+      }
+      // The value of the call replaces the procedure, and the caller continues
+      stack[base - 1] = std::move(stack.back());
+      stack.resize(base);
+      const CallFrame& caller = calls.back();
+      code = caller.code;
+      start = code->instructions.data();
+      ip = caller.returnTo;
+      base = caller.base;
+      closure = caller.closure;
+      calls.pop_back();
+      NEXT();
+    }
+  }
+}
+
+#undef BINARY_OPERATION
+#undef SHORT_CIRCUIT
+#undef ENTER_PROCEDURE
+#undef NUMBER_OPERATION
+#undef NUMBER_FOLD
+#undef NUMBER_COMPARISON
+#undef DISPATCH_LOOP
+#undef HANDLER
+#undef NEXT
+#undef COUNT_OPCODE
+
+/**
+ * Slow path of the inline binary operations: runs the builtin procedure itself, which either
+ * computes the result or reports why the operands are invalid.
+ */
+void VirtualMachine::callBinaryBuiltin(const Bytecode& code, const Instruction& instruction, SymbolId op) {
+  if (instruction.count == 1) {
+    stack.push_back(code.constants[instruction.operand]);
+  }
+  size_t base = stack.size() - 2;
+  Expression value;
+  findBuiltin(op)->procedure(stack.data() + base, 2, value);
+  stack[base] = std::move(value);
+  stack.resize(base + 1);
+}
+
+/**
+ * Calls the special form or builtin procedure `op` with `count` evaluated arguments.
+ */
+void callProcedure(Environment& environment, SymbolId op, Expression* args, size_t count, Expression& value) {
+  checkArity(op, count);
+  switch (op.value) {
+    case SYMBOL_DEFINE:
+      if (args[0].type != AtomType::Symbol) {
+        throw InterpreterSemanticError("Error: define requires a symbol as its first argument");
+      }
+      checkDefinable(args[0].symbol);
+
+      // Store the value under the symbol and also return it as the value of the define
+      environment.addSymbol(args[0].symbol, args[1]);
+      value = std::move(args[1]);
+      break;
+    case SYMBOL_BEGIN:
+      // The arguments have already been evaluated in order; the last one is the result
+      value = std::move(args[count - 1]);
+      break;
+    case SYMBOL_IF:
+      if (args[0].type != AtomType::Boolean) {
+        throw InterpreterSemanticError("Error: if requires a boolean condition");
+      }
+      value = std::move(args[0].boolValue ? args[1] : args[2]);
+      break;
+    case SYMBOL_LAMBDA:
+    case SYMBOL_LET:
+      // Its operands have been evaluated, so there are no variables or body left to use
+      throw InterpreterSemanticError("Error: " + symbolName(op) + " can only be used as a special form");
+    default:
+      findBuiltin(op)->procedure(args, count, value);
+      break;
+  }
+}
+
+/**
+ * Evaluates a list whose meaning is only known at run time, given its evaluated elements.
+ */
+void applyList(Environment& environment, Expression* elements, size_t count, Expression& value) {
+  if (count > 0 && elements[0].type == AtomType::Symbol) {
+    callProcedure(environment, elements[0].symbol, elements + 1, count - 1, value);
+  } else if (count > 0 && elements[0].type == AtomType::Procedure) {
+    throw InterpreterSemanticError("Error: procedures can only be called by the interpreter");
+  } else if (count == 1) {
+    // A list of a single value, such as `(4)`, evaluates to that value
+    value = std::move(elements[0]);
+  } else {
+    // Not a procedure call: the result is the list of evaluated elements
+    ExpressionList& items = value.children();
+    items.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      items.push_back(std::move(elements[i]));
+    }
+  }
+}
@@ -0,0 +1,108 @@
+#ifndef VM_HPP // Prevent multiple inclusions
+#define VM_HPP   // Define a unique identifier for the header file
+
+#include <cstddef>          // Include cstddef for size_t
+#include <cstdint>          // Include cstdint for the opcode counters
+#include <vector>           // Include vector for the value stack
+#include "bytecode.hpp"     // Include header file for Bytecode
+#include "environment.hpp"  // Include header file for Environment class
+#include "expression.hpp"   // Include header file for Expression class
+
+/**
+ * This header file defines the `VirtualMachine` class, which executes compiled bytecode.
+ */
+
+#ifdef SLISP_COUNT_OPCODES
+/**
+ * Opcode counters maintained by instrumentation builds (configure with `-DSLISP_COUNT_OPCODES=ON`).
+ *
+ *  - executed: how many times each opcode ran.
+ *  - pairs: how many times opcode `b` ran right after opcode `a` (`pairs[a][b]`), which shows
+ *    which sequences are worth fusing into a single instruction.
+ *
+ * The counters are not synchronized and are only meant for single-threaded measurements.
+ */
+struct OpcodeCounts {
+  uint64_t executed[OPCODE_COUNT];
+  uint64_t pairs[OPCODE_COUNT][OPCODE_COUNT];
+};
+
+/**
+ * Returns the process-wide opcode counters.
+ */
+OpcodeCounts& opcodeCounts();
+#endif
+class VirtualMachine {
+public:
+  /**
+   * Constructor for the `VirtualMachine` class. Definitions made by programs it runs are
+   * stored in `environment`.
+   */
+  explicit VirtualMachine(Environment& environment);
+
+  /**
+   * Runs a compiled program and returns its value.
+   *
+   * The value stack is kept between runs, so running programs of similar size does not allocate.
+   * Semantic errors are reported by throwing an `InterpreterSemanticError`. In JIT builds, the
+   * hot numeric regions of `program` are compiled into it as they are found.
+   */
+  Expression run(Bytecode& program);
+
+  /**
+   * Sets how many procedure calls may be open at once (see `checkDepth`); calls in tail
+   * position do not count. The default is `DEFAULT_DEPTH_LIMIT`.
+   */
+  void setDepthLimit(size_t limit);
+
+  /**
+   * Enables or disables running hot numeric regions as machine code, which is enabled by
+   * default. Has no effect unless the JIT is built in (see `jit.hpp`).
+   */
+  void setJit(bool enabled);
+
+private:
+  void callBinaryBuiltin(const Bytecode& code, const Instruction& instruction, SymbolId op);
+
+  /**
+   * A procedure call waiting for the one it made to return: the code to continue, the index of
+   * its arguments on the value stack, and its closure.
+   */
+  struct CallFrame {
+    Bytecode* code;
+    const Instruction* returnTo;
+    size_t base;
+    const Closure* closure;
+  };
+
+  Environment& environment;
+  std::vector<Expression> stack;
+  std::vector<double> numbers; // Unboxed values of the numeric region being run
+  std::vector<CallFrame> calls; // Calls of the procedures being run, innermost last
+  size_t depthLimit;
+  bool jit;
+};
+
+/**
+ * Calls the special form or builtin procedure `op` with `count` evaluated arguments, storing the
+ * result in `value`.
+ *
+ * This is the slow path for calls whose procedure is only known at run time, so the argument
+ * count is checked here. The arguments are temporaries owned by the caller and may be moved from.
+ */
+void callProcedure(Environment& environment, SymbolId op, Expression* args, size_t count, Expression& value);
+
+/**
+ * Evaluates a list whose meaning is only known at run time, given its `count` evaluated elements,
+ * storing the result in `value`.
+ *
+ * A list headed by a symbol is a call (see `callProcedure`), a list of a single value evaluates
+ * to that value, and any other list evaluates to the list of its elements. The elements are
+ * temporaries owned by the caller and may be moved from.
+ *
+ * A list headed by a procedure made by `lambda` is a call too, but only the evaluators can run
+ * its body, so they call it before getting here; this reports an error.
+ */
+void applyList(Environment& environment, Expression* elements, size_t count, Expression& value);
+
+#endif // VM_HPP // Guard against multiple inclusions
@@ -0,0 +1,2 @@
+// The tests use Catch2 2.x as installed on the system (see the tests section of CMakeLists.txt)
+#include <catch2/catch.hpp>
@@ -0,0 +1,46 @@
+#include "catch.hpp"
+
+#include <string>
+#include <sstream>
+
+#include "test_engines.hpp"
+
+TEST_CASE( "Test arity errors of special forms", "[analysis]" ) {
+
+  REQUIRE(error("(define x)") == "Error: define requires exactly 2 arguments");
+  REQUIRE(error("(define x 1 2)") == "Error: define requires exactly 2 arguments");
+  REQUIRE(error("(begin)") == "Error: begin requires at least 1 argument");
+  REQUIRE(error("(if True 1)") == "Error: if requires exactly 3 arguments");
+  REQUIRE(error("(lambda (x))") == "Error: lambda requires exactly 2 arguments");
+  REQUIRE(error("(let ((x 1)))") == "Error: let requires exactly 2 arguments");
+  REQUIRE(error("(or)") == "Error: or requires at least 1 argument");
+}
+
+TEST_CASE( "Test arity errors of builtin procedures", "[analysis]" ) {
+
+  REQUIRE(error("(not)") == "Error: not requires exactly 1 argument");
+  REQUIRE(error("(- 1 2 3)") == "Error: - requires between 1 and 2 arguments");
+  REQUIRE(error("(log10 1 2)") == "Error: log10 requires exactly 1 argument");
+  REQUIRE(error("(pow 2)") == "Error: pow requires exactly 2 arguments");
+  REQUIRE(error("(f 1 2)") == "Error: unknown procedure f");
+}
+
+TEST_CASE( "Test arity errors are reported before evaluation", "[analysis]" ) {
+
+  // The bad call is never reached, but the whole program is checked before any of it runs
+  REQUIRE(error("(if True 1 (- 1 2 3))") == "Error: - requires between 1 and 2 arguments");
+
+  for(auto engine : engines){
+    Interpreter interp;
+    interp.setEngine(engine);
+
+    std::istringstream iss("(begin (define x 1) (not 1 2))");
+    REQUIRE(interp.parse(iss) == true);
+    REQUIRE_THROWS_AS(interp.eval(), InterpreterSemanticError);
+
+    // So the define before it did not happen either
+    std::istringstream next("(x)");
+    REQUIRE(interp.parse(next) == true);
+    REQUIRE_THROWS_AS(interp.eval(), InterpreterSemanticError);
+  }
+}
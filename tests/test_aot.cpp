@@ -0,0 +1,115 @@
+#include "catch.hpp"
+
+#include <functional>
+#include <string>
+#include <sstream>
+
+#include "interpreter_semantic_error.hpp"
+#include "interpreter.hpp"
+#include "expression.hpp"
+#include "environment.hpp"
+#include "test_config.hpp"
+
+#include "test_aot_guards.hpp"
+#include "test_aot_division.hpp"
+#include "test_aot_let.hpp"
+
+// What evaluating tests/aot/<script> gives after evaluating setup, with both engines and as the
+// function it was translated into, called with an environment holding what setup defines: its
+// value, printed, or its error message. All three must agree.
+static std::string compareWithInterpreter(const std::string & script,
+                                          const std::function<Expression(Environment&)> & translated,
+                                          const std::string & setup){
+
+  std::string expected;
+  for(auto engine : {EvaluationEngine::Tree, EvaluationEngine::Bytecode}){
+    Interpreter interp;
+    interp.setEngine(engine);
+    std::ostringstream oss;
+    if(!setup.empty()){
+      std::istringstream iss(setup);
+      REQUIRE(interp.parse(iss) == true);
+      interp.eval();
+    }
+    REQUIRE(interp.parseFile(TEST_FILE_DIR + "/aot/" + script) == true);
+    try{
+      oss << interp.eval();
+    }
+    catch(const InterpreterSemanticError & e){
+      oss << e.what();
+    }
+    if(engine == EvaluationEngine::Tree){
+      expected = oss.str();
+    }
+    REQUIRE(oss.str() == expected);
+  }
+
+  Environment environment;
+  if(!setup.empty()){
+    Interpreter interp;
+    std::istringstream iss(setup);
+    REQUIRE(interp.parse(iss) == true);
+    environment.addSymbol("x", interp.eval());
+  }
+  // Twice, since the first call leaves its definitions in the environment
+  for(int i = 0; i < 2; ++i){
+    std::ostringstream oss;
+    try{
+      oss << translated(environment);
+    }
+    catch(const InterpreterSemanticError & e){
+      oss << e.what();
+    }
+    REQUIRE(oss.str() == expected);
+  }
+
+  return expected;
+}
+
+static std::string printed(const Expression & value){
+
+  std::ostringstream oss;
+  oss << value;
+  return oss.str();
+}
+
+TEST_CASE( "Test translated guards against the interpreter", "[aot]" ) {
+
+  REQUIRE(compareWithInterpreter("guards.slp", aot_guards, "(define x 1)") == printed(Expression(4.)));
+  REQUIRE(compareWithInterpreter("guards.slp", aot_guards, "(define x 4)") == printed(Expression(5.)));
+
+  // x is not a number, or not defined at all, so the guards fall back to the builtin procedures
+  REQUIRE(compareWithInterpreter("guards.slp", aot_guards, "(define x True)") ==
+          "Error: Multiplication requires numeric arguments");
+  REQUIRE(compareWithInterpreter("guards.slp", aot_guards, "") ==
+          "Error: Multiplication requires numeric arguments");
+}
+
+TEST_CASE( "Test translated numeric regions dividing by zero", "[aot]" ) {
+
+  REQUIRE(compareWithInterpreter("division.slp", aot_division, "(define x 5)") == printed(Expression(5.)));
+  REQUIRE(compareWithInterpreter("division.slp", aot_division, "(define x 3)") == "Error: Division by zero");
+}
+
+TEST_CASE( "Test translated let slots against the interpreter", "[aot]" ) {
+
+  REQUIRE(compareWithInterpreter("let.slp", aot_let, "(define x 4)") == printed(Expression(8.)));
+  REQUIRE(compareWithInterpreter("let.slp", aot_let, "(define x False)") ==
+          "Error: Multiplication requires numeric arguments");
+}
+
+TEST_CASE( "Test programs using lambda are not translated", "[aot]" ) {
+
+  Interpreter interp;
+  std::istringstream iss("(begin (define f (lambda (a) (* a 2))) (f 3))");
+  REQUIRE(interp.parse(iss) == true);
+
+  std::ostringstream source;
+  try{
+    interp.translate("doubled", source);
+    FAIL("translating lambda did not throw");
+  }
+  catch(const InterpreterSemanticError & e){
+    REQUIRE(std::string(e.what()) == "Error: cannot translate a program that uses lambda");
+  }
+}
@@ -0,0 +1,58 @@
+#ifndef TEST_ENGINES_HPP
+#define TEST_ENGINES_HPP
+
+#include "catch.hpp"
+
+#include <string>
+#include <sstream>
+
+#include "interpreter_semantic_error.hpp"
+#include "interpreter.hpp"
+#include "expression.hpp"
+
+static const EvaluationEngine engines[] = {EvaluationEngine::Tree, EvaluationEngine::Bytecode};
+
+// Evaluates program with both engines, which must agree on its value
+inline Expression run(const std::string & program, size_t depthLimit = DEFAULT_DEPTH_LIMIT){
+
+  Expression results[2];
+  for(int i = 0; i < 2; ++i){
+    std::istringstream iss(program);
+
+    Interpreter interp;
+    interp.setEngine(engines[i]);
+    interp.setDepthLimit(depthLimit);
+
+    REQUIRE(interp.parse(iss) == true);
+    REQUIRE_NOTHROW(results[i] = interp.eval());
+  }
+  REQUIRE(results[0] == results[1]);
+
+  return results[1];
+}
+
+// Returns the message of the semantic error program raises, which must be the same with both engines
+inline std::string error(const std::string & program, size_t depthLimit = DEFAULT_DEPTH_LIMIT){
+
+  std::string messages[2];
+  for(int i = 0; i < 2; ++i){
+    std::istringstream iss(program);
+
+    Interpreter interp;
+    interp.setEngine(engines[i]);
+    interp.setDepthLimit(depthLimit);
+
+    REQUIRE(interp.parse(iss) == true);
+    try{
+      interp.eval();
+    }
+    catch(const InterpreterSemanticError & e){
+      messages[i] = e.what();
+    }
+  }
+  REQUIRE(messages[0] == messages[1]);
+
+  return messages[1];
+}
+
+#endif // TEST_ENGINES_HPP
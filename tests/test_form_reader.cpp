@@ -0,0 +1,157 @@
+#include "catch.hpp"
+
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <vector>
+
+#include "interpreter_semantic_error.hpp"
+#include "interpreter.hpp"
+#include "expression.hpp"
+#include "form_reader.hpp"
+
+// Forms of varying length that together span several refill buffers, so that some of them
+// straddle each buffer boundary, at a different offset every time
+static std::vector<std::string> manyForms(){
+
+  std::vector<std::string> forms;
+  size_t size = 0;
+  for(int i = 0; size < 4 * FormReader::DEFAULT_BUFFER_SIZE; ++i){
+    std::string form = "(+ " + std::to_string(i);
+    for(int j = 0; j < i % 37; ++j){
+      form += " 1";
+    }
+    form += ")";
+    size += form.size() + 1;
+    forms.push_back(form);
+  }
+  return forms;
+}
+
+// Runs runStream on input, returning what it printed to std::cout and std::cerr
+static void runStream(const std::string & input, std::string & out, std::string & err){
+
+  std::istringstream iss(input);
+  std::ostringstream outStream;
+  std::ostringstream errStream;
+  std::streambuf * oldOut = std::cout.rdbuf(outStream.rdbuf());
+  std::streambuf * oldErr = std::cerr.rdbuf(errStream.rdbuf());
+
+  Interpreter interp;
+  interp.runStream(iss);
+
+  std::cout.rdbuf(oldOut);
+  std::cerr.rdbuf(oldErr);
+  out = outStream.str();
+  err = errStream.str();
+}
+
+static std::string printed(const Expression & value){
+
+  std::ostringstream oss;
+  oss << value << std::endl;
+  return oss.str();
+}
+
+TEST_CASE( "Test form reader with forms split across refills", "[stream]" ) {
+
+  std::vector<std::string> forms = manyForms();
+  std::string input;
+  for(size_t i = 0; i < forms.size(); ++i){
+    input += forms[i] + (i % 5 == 0 ? " ; a comment\n" : "\n");
+  }
+
+  for(size_t bufferSize : {size_t(1), size_t(7), size_t(4096), FormReader::DEFAULT_BUFFER_SIZE}){
+    std::istringstream iss(input);
+    FormReader reader(iss, bufferSize);
+
+    std::string form;
+    size_t count = 0;
+    while(reader.next(form)){
+      REQUIRE(count < forms.size());
+      REQUIRE(form == forms[count]);
+      ++count;
+    }
+    REQUIRE(count == forms.size());
+  }
+}
+
+TEST_CASE( "Test form reader with a form larger than the buffer", "[stream]" ) {
+
+  std::string form = "(+";
+  while(form.size() < 3 * FormReader::DEFAULT_BUFFER_SIZE){
+    form += " 1";
+  }
+  form += ")";
+
+  std::istringstream iss(form + "\n(- 1)");
+  FormReader reader(iss);
+
+  std::string read;
+  REQUIRE(reader.next(read) == true);
+  REQUIRE(read == form);
+  REQUIRE(reader.next(read) == true);
+  REQUIRE(read == "(- 1)");
+  REQUIRE(reader.next(read) == false);
+}
+
+TEST_CASE( "Test form reader errors", "[stream]" ) {
+
+  {
+    std::istringstream iss("(+ 1 2) )");
+    FormReader reader(iss);
+    std::string form;
+    REQUIRE(reader.next(form) == true);
+    REQUIRE_THROWS_AS(reader.next(form), InterpreterSemanticError);
+  }
+
+  {
+    std::istringstream iss("(+ 1 2) (+ 3");
+    FormReader reader(iss);
+    std::string form;
+    REQUIRE(reader.next(form) == true);
+    REQUIRE_THROWS_AS(reader.next(form), InterpreterSemanticError);
+  }
+}
+
+TEST_CASE( "Test runStream evaluates every form across refills", "[stream]" ) {
+
+  std::vector<std::string> forms = manyForms();
+  std::string input;
+  std::string expected;
+  for(size_t i = 0; i < forms.size(); ++i){
+    input += forms[i] + "\n";
+    expected += printed(Expression(double(i + i % 37)));
+  }
+
+  std::string out;
+  std::string err;
+  runStream(input, out, err);
+  REQUIRE(out == expected);
+  REQUIRE(err.empty());
+}
+
+TEST_CASE( "Test runStream error messages", "[stream]" ) {
+
+  std::string out;
+  std::string err;
+
+  // Evaluation errors are reported and the stream goes on
+  runStream("(+ 1 2)\n(/ 1 0)\n(+ 3 4)\n", out, err);
+  REQUIRE(out == printed(Expression(3.)) + printed(Expression(7.)));
+  REQUIRE(err == "Error: Division by zero\n");
+
+  // Forms that fail to parse are reported and skipped
+  runStream("(+ 1 2)\n42\n(+ 3 4)\n", out, err);
+  REQUIRE(out == printed(Expression(3.)) + printed(Expression(7.)));
+  REQUIRE(err == "Error: Failed to parse input.\n");
+
+  // The reader cannot recover from unbalanced parentheses, so the stream stops
+  runStream("(+ 1 2)\n)\n(+ 3 4)\n", out, err);
+  REQUIRE(out == printed(Expression(3.)));
+  REQUIRE(err == "Error: unexpected ')'\n");
+
+  runStream("(+ 1 2)\n(+ 3 4", out, err);
+  REQUIRE(out == printed(Expression(3.)));
+  REQUIRE(err == "Error: unexpected end of input inside a form\n");
+}
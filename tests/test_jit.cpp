@@ -0,0 +1,87 @@
+#include "catch.hpp"
+
+#include <string>
+#include <sstream>
+
+#include "interpreter_semantic_error.hpp"
+#include "interpreter.hpp"
+#include "expression.hpp"
+#include "jit.hpp"
+
+#ifdef SLISP_JIT
+
+// What evaluating the program parsed into interp gives: its value, printed, or its error message
+static std::string outcome(Interpreter & interp){
+
+  std::ostringstream oss;
+  try{
+    oss << interp.eval();
+  }
+  catch(const InterpreterSemanticError & e){
+    oss << e.what();
+  }
+  return oss.str();
+}
+
+// Evaluates setup, then program over and over, well past the point where its numeric regions
+// are compiled to machine code. Every evaluation must give the same outcome as with the tree
+// walker and with the bytecode engine without the JIT.
+static void compareWithInterpreter(const std::string & setup, const std::string & program){
+
+  Interpreter tree;
+  Interpreter interpreted;
+  Interpreter jit;
+  tree.setEngine(EvaluationEngine::Tree);
+  interpreted.setJit(false);
+  jit.setJit(true);
+
+  for(Interpreter * interp : {&tree, &interpreted, &jit}){
+    std::istringstream first(setup);
+    REQUIRE(interp->parse(first) == true);
+    interp->eval();
+    std::istringstream second(program);
+    REQUIRE(interp->parse(second) == true);
+  }
+
+  for(uint32_t i = 0; i < 2 * JIT_THRESHOLD; ++i){
+    std::string expected = outcome(tree);
+    REQUIRE(outcome(interpreted) == expected);
+    REQUIRE(outcome(jit) == expected);
+  }
+}
+
+TEST_CASE( "Test JIT regions against the interpreter", "[jit]" ) {
+
+  compareWithInterpreter("(define k 0)",
+                         "(begin (define k (+ k 1)) (- (* k (+ k 0.5)) (/ k 3)))");
+  compareWithInterpreter("(define k 0)",
+                         "(begin (define k (+ k 1)) (< (* k 2) (+ k 150)))");
+  compareWithInterpreter("(define k 0)",
+                         "(begin (define k (+ k 1)) (pow (- k 100) 2))");
+}
+
+TEST_CASE( "Test JIT regions with guards that fail", "[jit]" ) {
+
+  // z stops being a number after the region has been compiled, so its guard sends the
+  // evaluation to the fallback, which reports the error
+  compareWithInterpreter("(begin (define k 0) (define z 0))",
+                         "(begin (define k (+ k 1)) (define z (if (< k 150) k True))"
+                         "  (+ (* z 2) (* z 3)))");
+}
+
+TEST_CASE( "Test JIT regions dividing by zero", "[jit]" ) {
+
+  compareWithInterpreter("(define k 0)",
+                         "(begin (define k (+ k 1)) (/ (* k 2) (- k 150)))");
+}
+
+TEST_CASE( "Test JIT regions with let variables", "[jit]" ) {
+
+  // The regions compute values stored in let slots, between slots holding other values
+  compareWithInterpreter("(define k 0)",
+                         "(begin (define k (+ k 1))"
+                         "  (let ((b k) (a (+ (* k 2) (* k 3))))"
+                         "    (let ((c (- (* k k) (* k 2)))) (- a (+ b c)))))");
+}
+
+#endif // SLISP_JIT
@@ -0,0 +1,109 @@
+#include "catch.hpp"
+
+#include <string>
+
+#include "test_engines.hpp"
+
+TEST_CASE( "Test lambda closures capture their variables", "[lambda]" ) {
+
+  {
+    std::string program = "((lambda (x y) (+ x y)) 1 2)";
+    Expression result = run(program);
+    REQUIRE(result == Expression(3.));
+  }
+
+  {
+    std::string program =
+      "(begin (define make-adder (lambda (n) (lambda (x) (+ x n))))"
+      "(define add3 (make-adder 3)) (add3 4))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(7.));
+  }
+
+  {
+    // Variables of the environment are looked up when the body runs, not captured
+    std::string program = "(begin (define n 10) (define f (lambda (x) (+ x n))) (define n 20) (f 1))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(21.));
+  }
+}
+
+TEST_CASE( "Test nested lambdas", "[lambda]" ) {
+
+  {
+    std::string program = "((((lambda (a) (lambda (b) (lambda (c) (- a (- b c))))) 10) 4) 1)";
+    Expression result = run(program);
+    REQUIRE(result == Expression(7.));
+  }
+
+  {
+    // The middle lambda does not use a, but must capture it for the inner one
+    std::string program = "((((lambda (a) (lambda (b) (lambda (c) (+ a c)))) 1) 2) 3)";
+    Expression result = run(program);
+    REQUIRE(result == Expression(4.));
+  }
+
+  {
+    std::string program = "((lambda (x) ((lambda (x) (* x 2)) (+ x 1))) 4)";
+    Expression result = run(program);
+    REQUIRE(result == Expression(10.));
+  }
+}
+
+TEST_CASE( "Test lambda with no parameters", "[lambda]" ) {
+
+  {
+    std::string program = "(begin (define f (lambda () 7)) (f))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(7.));
+  }
+
+  {
+    std::string program = "(begin (define x 2) (define g (lambda () (lambda () (* x 3)))) ((g)))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(6.));
+  }
+
+  REQUIRE(error("(begin (define f (lambda () 7)) (f 1))") == "Error: procedure requires exactly 0 arguments");
+}
+
+TEST_CASE( "Test empty lists are only parameter lists", "[lambda]" ) {
+
+  REQUIRE(error("(())") == "Error: cannot apply an empty list");
+  REQUIRE(error("(begin (define x ()) 1)") == "Error: cannot apply an empty list");
+  REQUIRE(error("(if False () 1)") == "Error: cannot apply an empty list");
+  REQUIRE(error("(lambda () ())") == "Error: cannot apply an empty list");
+}
+
+TEST_CASE( "Test lambda calls with the wrong number of arguments", "[lambda]" ) {
+
+  REQUIRE(error("((lambda (x y) (+ x y)) 1)") == "Error: procedure requires exactly 2 arguments");
+  REQUIRE(error("((lambda (x) x) 1 2)") == "Error: procedure requires exactly 1 argument");
+}
+
+TEST_CASE( "Test lambda with invalid parameters", "[lambda]" ) {
+
+  REQUIRE(error("(lambda (x x) x)") == "Error: lambda parameter x appears more than once");
+  REQUIRE(error("(lambda (pi) pi)") == "Error: cannot redefine builtin symbol pi");
+  REQUIRE(error("(lambda (1) 1)") == "Error: lambda requires a list of symbols as its first argument");
+  REQUIRE(error("(lambda x x)") == "Error: lambda requires a list of symbols as its first argument");
+}
+
+TEST_CASE( "Test tail calls run in constant space", "[lambda]" ) {
+
+  {
+    std::string program =
+      "(begin (define loop (lambda (n acc) (if (= n 0) acc (loop (- n 1) (+ acc 1)))))"
+      "(loop 100000 0))";
+    Expression result = run(program, 100);
+    REQUIRE(result == Expression(100000.));
+  }
+
+  {
+    // The same recursion outside tail position needs a level per call
+    std::string program =
+      "(begin (define count (lambda (n) (if (= n 0) 0 (+ 1 (count (- n 1))))))"
+      "(count 100000))";
+    REQUIRE(error(program, 100) == "Error: program is nested more than 100 levels deep");
+  }
+}
@@ -0,0 +1,83 @@
+#include "catch.hpp"
+
+#include <string>
+
+#include "test_engines.hpp"
+
+TEST_CASE( "Test let binds its variables in its body", "[let]" ) {
+
+  {
+    std::string program = "(let ((x 1) (y 2)) (+ x y))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(3.));
+  }
+
+  {
+    // The values are evaluated outside the form, so y gets the x of the environment
+    std::string program = "(begin (define x 5) (let ((x 1) (y x)) y))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(5.));
+  }
+
+  {
+    std::string program = "(let () 5)";
+    Expression result = run(program);
+    REQUIRE(result == Expression(5.));
+  }
+}
+
+TEST_CASE( "Test let shadowing", "[let]" ) {
+
+  {
+    std::string program = "(let ((x 1)) (let ((x (+ x 1))) (+ x (let ((x 10)) x))))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(12.));
+  }
+
+  {
+    // The inner form gives x back once it ends
+    std::string program = "(let ((x 1)) (+ (let ((x 2)) x) x))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(3.));
+  }
+}
+
+TEST_CASE( "Test let inside lambda", "[let]" ) {
+
+  {
+    std::string program = "(begin (define f (lambda (x) (let ((x (* x 2))) x))) (f 4))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(8.));
+  }
+
+  {
+    std::string program =
+      "(begin (define f (lambda (a) (let ((b (* a 2))) (let ((a (+ b 1))) (- a b)))))"
+      "(f 5))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(1.));
+  }
+
+  {
+    // A lambda inside the form captures the parameter around it
+    std::string program = "(begin (define f (lambda (n) (let ((g (lambda (x) (* x n)))) (g 3)))) (f 7))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(21.));
+  }
+
+  {
+    // A let in tail position of a procedure body keeps its calls in tail position
+    std::string program =
+      "(begin (define loop (lambda (n) (let ((m (- n 1))) (if (= m 0) 0 (loop m)))))"
+      "(loop 100000))";
+    Expression result = run(program, 100);
+    REQUIRE(result == Expression(0.));
+  }
+}
+
+TEST_CASE( "Test let with invalid bindings", "[let]" ) {
+
+  REQUIRE(error("(let ((pi 3)) pi)") == "Error: cannot redefine builtin symbol pi");
+  REQUIRE(error("(let ((x 1) (x 2)) x)") == "Error: let variable x appears more than once");
+  REQUIRE(error("(let (x 1) x)") == "Error: let requires a list of (symbol value) pairs as its first argument");
+}
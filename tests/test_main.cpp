@@ -0,0 +1,2 @@
+#define CATCH_CONFIG_MAIN // Let Catch provide main() for the test executable
+#include "catch.hpp"
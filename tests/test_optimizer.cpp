@@ -0,0 +1,69 @@
+#include "catch.hpp"
+
+#include <string>
+
+#include "test_engines.hpp"
+
+TEST_CASE( "Test folds that would fail still fail at run time", "[optimizer]" ) {
+
+  REQUIRE(error("(/ 1 0)") == "Error: Division by zero");
+  REQUIRE(error("(+ 1 (/ 1 0))") == "Error: Division by zero");
+  REQUIRE(error("(if True (/ 1 0) 1)") == "Error: Division by zero");
+  REQUIRE(error("(begin (/ 1 0) 1)") == "Error: Division by zero");
+  REQUIRE(error("(and True (/ 1 0))") == "Error: Division by zero");
+  REQUIRE(error("(+ 1 True)") == "Error: Addition requires numeric arguments");
+}
+
+TEST_CASE( "Test folds that would fail in code that never runs", "[optimizer]" ) {
+
+  {
+    std::string program = "(if False (/ 1 0) 2)";
+    Expression result = run(program);
+    REQUIRE(result == Expression(2.));
+  }
+
+  {
+    std::string program = "(and False (/ 1 0))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(false));
+  }
+
+  {
+    std::string program = "(or True (+ 1 True))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(true));
+  }
+}
+
+TEST_CASE( "Test and, or and if keep checking their operands", "[optimizer]" ) {
+
+  REQUIRE(error("(and True 1)") == "Error: and requires boolean arguments");
+  REQUIRE(error("(and 1)") == "Error: and requires boolean arguments");
+  REQUIRE(error("(or False 1)") == "Error: or requires boolean arguments");
+  REQUIRE(error("(begin (define b 1) (and True b))") == "Error: and requires boolean arguments");
+  REQUIRE(error("(begin (define b 1) (or False b))") == "Error: or requires boolean arguments");
+  REQUIRE(error("(if 1 2 3)") == "Error: if requires a boolean condition");
+  REQUIRE(error("(if (< 1 2) (+ True 1) 0)") == "Error: Addition requires numeric arguments");
+
+  {
+    std::string program = "(begin (define b True) (and True b))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(true));
+  }
+}
+
+TEST_CASE( "Test arithmetic identities keep checking their operands", "[optimizer]" ) {
+
+  REQUIRE(error("(begin (define b True) (+ b 0))") == "Error: Addition requires numeric arguments");
+  REQUIRE(error("(begin (define b True) (+ 0 b))") == "Error: Addition requires numeric arguments");
+  REQUIRE(error("(begin (define b True) (- b 0))") == "Error: Subtraction requires numeric arguments");
+  REQUIRE(error("(begin (define b True) (* 1 b))") == "Error: Multiplication requires numeric arguments");
+  REQUIRE(error("(begin (define b True) (/ b 1))") == "Error: Division requires numeric arguments");
+  REQUIRE(error("(begin (define b True) (pow b 1))") == "Error: pow requires numeric arguments");
+
+  {
+    std::string program = "(begin (define x 5) (* 1 (+ x 0)))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(5.));
+  }
+}
@@ -0,0 +1,79 @@
+#include "catch.hpp"
+
+#include <string>
+#include <sstream>
+#include <vector>
+
+#include "interpreter.hpp"
+#include "expression.hpp"
+
+// Parses program both from a string and from a stream, which must agree
+static bool parses(const std::string & program){
+
+  std::string text = program;
+  Interpreter fromString;
+  bool ok = fromString.parse(text);
+
+  std::istringstream iss(program);
+  Interpreter fromStream;
+  REQUIRE(fromStream.parse(iss) == ok);
+
+  return ok;
+}
+
+TEST_CASE( "Test parser with a stray closing parenthesis", "[parser]" ) {
+
+  std::vector<std::string> programs = {")",
+                                       ")(+ 1 2)",
+                                       "(+ 1 2))",
+                                       "(begin (define r 10) (* r r)))"};
+  for(auto s : programs){
+    REQUIRE(parses(s) == false);
+  }
+}
+
+TEST_CASE( "Test parser with unterminated input", "[parser]" ) {
+
+  std::vector<std::string> programs = {"(",
+                                       "((",
+                                       "(+ 1 (* 2 3)",
+                                       "(begin (define r 10) (* r r)"};
+  for(auto s : programs){
+    REQUIRE(parses(s) == false);
+  }
+}
+
+TEST_CASE( "Test parser with a top-level atom", "[parser]" ) {
+
+  std::vector<std::string> programs = {"42", "-1.5", "True", "x"};
+  for(auto s : programs){
+    REQUIRE(parses(s) == false);
+  }
+}
+
+TEST_CASE( "Test parser with trailing input", "[parser]" ) {
+
+  std::vector<std::string> programs = {"(+ 1 2) 3",
+                                       "(+ 1 2) x",
+                                       "(+ 1 2) (",
+                                       "(+ 1 2) (+ 3 4)"};
+  for(auto s : programs){
+    REQUIRE(parses(s) == false);
+  }
+}
+
+TEST_CASE( "Test parser with comments and whitespace around the program", "[parser]" ) {
+
+  REQUIRE(parses("  ; a comment\n(+ 1 2) ; another\n") == true);
+  REQUIRE(parses("(+ 1\n  ; inside\n  2)") == true);
+}
+
+TEST_CASE( "Test parser with deeply nested lists", "[parser]" ) {
+
+  // The parser keeps open lists on a stack of its own, so nesting is not limited by recursion
+  const int depth = 100000;
+  std::string program = std::string(depth, '(') + "1" + std::string(depth, ')');
+  REQUIRE(parses(program) == true);
+  REQUIRE(parses(program + ")") == false);
+  REQUIRE(parses(program.substr(1)) == false);
+}
@@ -0,0 +1,67 @@
+#include "catch.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "structural_index.hpp"
+#include "tokenize.hpp"
+
+// Requires every SIMD scan mode the CPU supports to find the same tokens in input as the scalar scanner
+static void checkModes(const std::string & input){
+
+  std::vector<Token> expected = scanTokens(input, ScanMode::Scalar);
+  for(ScanMode mode : {ScanMode::SSE2, ScanMode::AVX2}){
+    if(!scanModeSupported(mode)){
+      continue;
+    }
+    std::vector<Token> tokens = scanTokens(input, mode);
+    REQUIRE(tokens.size() == expected.size());
+    for(size_t i = 0; i < tokens.size(); ++i){
+      REQUIRE(tokens[i].type == expected[i].type);
+      REQUIRE(tokens[i].offset == expected[i].offset);
+      REQUIRE(tokens[i].length == expected[i].length);
+      REQUIRE(tokens[i].line == expected[i].line);
+      if(tokens[i].type == Token::SYMBOL){
+        REQUIRE(tokens[i].symbol == expected[i].symbol);
+      }
+    }
+  }
+}
+
+TEST_CASE( "Test structural index against the scalar scanner across block boundaries", "[structural]" ) {
+
+  // Each body is shifted across the first two block boundaries one byte at a time
+  std::vector<std::string> bodies = {
+    "(begin (define r 10) (* pi (* r r)))",
+    "(" + std::string(100, 'a') + " " + std::string(70, '7') + ")",
+    "(+ 1 2) ; a comment that runs on past the end of the block\n(- 3 4)",
+    "(f\t1\r\n2\n\n\n3 ;\n)",
+    std::string(80, '(') + "True False 1abc -2.5e3 x" + std::string(80, ')'),
+    std::string(90, ' ') + "\n" + std::string(90, '\t') + "x",
+    ";only a comment"
+  };
+  for(const auto & body : bodies){
+    for(size_t pad = 0; pad <= 2 * STRUCTURAL_BLOCK_SIZE + 1; ++pad){
+      checkModes(std::string(pad, ' ') + body);
+      checkModes(std::string(pad, 'x') + body);
+      checkModes(body + std::string(pad, ' '));
+    }
+  }
+}
+
+TEST_CASE( "Test structural index against the scalar scanner on random input", "[structural]" ) {
+
+  const std::string alphabet = "()() \t\r\n;;abxTrueFals0123456789.-+e";
+  std::mt19937 random(12345);
+  std::uniform_int_distribution<size_t> length(0, 4 * STRUCTURAL_BLOCK_SIZE);
+  std::uniform_int_distribution<size_t> character(0, alphabet.size() - 1);
+
+  for(int i = 0; i < 5000; ++i){
+    std::string input(length(random), ' ');
+    for(auto & c : input){
+      c = alphabet[character(random)];
+    }
+    checkModes(input);
+  }
+}
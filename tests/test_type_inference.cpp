@@ -0,0 +1,92 @@
+#include "catch.hpp"
+
+#include <string>
+#include <sstream>
+#include <vector>
+
+#include "test_engines.hpp"
+
+// Evaluates programs in turn in one interpreter per engine, returning what each evaluated to
+// (printed) or the message of the error it raised. An empty program evaluates the last one again.
+static std::vector<std::string> session(const std::vector<std::string> & programs){
+
+  std::vector<std::string> results[2];
+  for(int i = 0; i < 2; ++i){
+    Interpreter interp;
+    interp.setEngine(engines[i]);
+    for(auto program : programs){
+      if(!program.empty()){
+        std::istringstream iss(program);
+        REQUIRE(interp.parse(iss) == true);
+      }
+      std::ostringstream oss;
+      try{
+        oss << interp.eval();
+      }
+      catch(const InterpreterSemanticError & e){
+        oss << e.what();
+      }
+      results[i].push_back(oss.str());
+    }
+  }
+  REQUIRE(results[0] == results[1]);
+
+  return results[1];
+}
+
+static std::string printed(const Expression & value){
+
+  std::ostringstream oss;
+  oss << value;
+  return oss.str();
+}
+
+TEST_CASE( "Test proofs are withdrawn when a later program redefines a variable", "[types]" ) {
+
+  {
+    std::vector<std::string> results = session({"(define x 1)",
+                                                "(+ x 1)",
+                                                "(define x True)",
+                                                "(+ x 1)"});
+    REQUIRE(results[1] == printed(Expression(2.)));
+    REQUIRE(results[3] == "Error: Addition requires numeric arguments");
+  }
+
+  {
+    // Arithmetic nested deeply enough to be compiled into a numeric region
+    std::vector<std::string> results = session({"(define x 1)",
+                                                "(+ (* x 2) (* x 3))",
+                                                "(define x True)",
+                                                "(+ (* x 2) (* x 3))"});
+    REQUIRE(results[1] == printed(Expression(5.)));
+    REQUIRE(results[3] == "Error: Multiplication requires numeric arguments");
+  }
+}
+
+TEST_CASE( "Test proofs are withdrawn when a program redefines a variable", "[types]" ) {
+
+  {
+    std::vector<std::string> results = session({"(define x 1)",
+                                                "(begin (define y (+ x 1)) (define x True) (+ x 1))"});
+    REQUIRE(results[1] == "Error: Addition requires numeric arguments");
+  }
+
+  {
+    // Evaluating the same program again sees the value it gave x the first time
+    std::vector<std::string> results = session({"(define x 1)",
+                                                "(begin (define y (+ (* x 2) (* x 3))) (define x True) y)",
+                                                ""});
+    REQUIRE(results[1] == printed(Expression(5.)));
+    REQUIRE(results[2] == "Error: Multiplication requires numeric arguments");
+  }
+
+  {
+    std::vector<std::string> results = session({"(define x 2)",
+                                                "(begin (define x (+ (* x x) (* x 1))) x)",
+                                                "",
+                                                ""});
+    REQUIRE(results[1] == printed(Expression(6.)));
+    REQUIRE(results[2] == printed(Expression(42.)));
+    REQUIRE(results[3] == printed(Expression(1806.)));
+  }
+}